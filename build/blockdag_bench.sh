@@ -0,0 +1,135 @@
+#!/bin/bash
+
+############################################################################################################################
+# Usage: ./blockdag_bench.sh [blocks...]      (default: 100000 1000000)
+# Environment: RATE, DELAY, PARENTS, SEED (generator), THREADS (-j), QUERIES (-c3 batch size),
+#              CONE_MAX (largest graph timed with -c9), TIMEOUT (seconds per step).
+SIZES=${@:-"100000 1000000"}
+RATE=${RATE:-1}
+DELAY=${DELAY:-2}
+PARENTS=${PARENTS:-8}
+SEED=${SEED:-1}
+THREADS=${THREADS:-1}
+QUERIES=${QUERIES:-1000}
+CONE_MAX=${CONE_MAX:-1000000}
+TIMEOUT=${TIMEOUT:-300}
+BENCH_DIR="bench"
+############################################################################################################################
+
+# ANSI colors
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+ORANGE='\033[0;33m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+function print_header {
+    header="${1}"
+    header_len=${#header}
+    printf "\n"
+    if [ $header_len -lt 71 ]; then
+        padding=$(((71 - $header_len) / 2))
+        for ((i = 0; i < $padding; i++)); do
+            printf " "
+        done
+    fi
+    printf "${BLUE}= %s =\n\n" "${header}"
+}
+
+# Run a command, keeping its wall time (ELAPSED, seconds) and peak resident memory (PEAK, kB).
+# The peak comes from GNU time when installed, else it is sampled from /proc while the
+# command runs (VmHWM only grows, short runs may be missed).
+function measure {
+    local start=$(date +%s%N)
+    PEAK=0
+    if [ -x /usr/bin/time ]; then
+        timeout $TIMEOUT /usr/bin/time -f "%M" -o bench.mem "$@" > /dev/null 2> bench.err
+        STATUS=$?
+        PEAK=$(tail -n 1 bench.mem 2> /dev/null)
+        ELAPSED=$(awk -v s=$start -v e=$(date +%s%N) 'BEGIN { printf "%.3f", (e - s) / 1e9 }')
+        return
+    fi
+    timeout $TIMEOUT "$@" > /dev/null 2> bench.err &
+    local pid=$!
+    while kill -0 $pid 2> /dev/null; do
+        for child in $(pgrep -P $pid) $pid; do
+            local hwm=$(awk '/VmHWM/ { print $2 }' /proc/$child/status 2> /dev/null)
+            [[ -n $hwm && $hwm -gt $PEAK ]] && PEAK=$hwm
+        done
+        sleep 0.01
+    done
+    wait $pid
+    STATUS=$?
+    ELAPSED=$(awk -v s=$start -v e=$(date +%s%N) 'BEGIN { printf "%.3f", (e - s) / 1e9 }')
+}
+
+# Print one row: step, time, throughput of count items (unit), peak memory.
+function report {
+    local step="${1}" count="${2}" unit="${3}"
+    if [ $STATUS -eq 124 ]; then
+        printf "${ORANGE}%-22s${RED} %10s${NC}\n" "$step" "timeout"
+    elif [ $STATUS -ne 0 ]; then
+        printf "${ORANGE}%-22s${RED} %10s${NC} %s\n" "$step" "failed" "$(head -c 80 bench.err)"
+    else
+        printf "${ORANGE}%-22s${GREEN} %9ss %14s %-9s %9.1f MB${NC}\n" "$step" "$ELAPSED" \
+            $(awk -v n=$count -v t=$ELAPSED 'BEGIN { printf "%.0f", (t > 0 ? n / t : n) }') \
+            "$unit/s" $(awk -v k=$PEAK 'BEGIN { print k / 1024 }')
+    fi
+}
+
+print_header "BLOCKCHAIN BENCHMARK"
+
+make build gen > /dev/null 2>&1 || { echo -e "${RED}Build failed${NC}"; exit 1; }
+mkdir -p $BENCH_DIR
+cd $BENCH_DIR
+
+for blocks in $SIZES
+do
+    echo -e "${BLUE}$blocks blocks (rate $RATE, delay $DELAY, parents $PARENTS, threads $THREADS)${NC}"
+
+    measure ../gendag -n $blocks -r $RATE -d $DELAY -p $PARENTS -s $SEED -o blockdag.in
+    report "generate" $blocks "blocks"
+    [ $STATUS -ne 0 ] && continue
+
+    edges=$(awk 'NR > 3 { e += NF - 2 } END { print e }' blockdag.in)
+    echo -e "${ORANGE}$(du -h blockdag.in | cut -f1) input, $edges edges${NC}"
+
+    # A spread of existing blocks for the queries, the newest one being a tip.
+    awk -v q=$QUERIES 'NR == 2 { step = NF > q ? int(NF / q) : 1; for (i = NF; i >= 1 && n < q; i -= step) { print $i; n++ } }' \
+        blockdag.in > blockdag.q
+    tip=$(head -n 1 blockdag.q)
+
+    measure ../blockdag -c1
+    report "load + validate (-c1)" $blocks "blocks"
+
+    measure ../blockdag -c4
+    report "topo order (-c4)" $blocks "blocks"
+
+    measure ../blockdag -c2 $tip -j $THREADS
+    report "past(tip) (-c2)" $blocks "blocks"
+
+    measure ../blockdag -c2 Genesis -j $THREADS
+    report "future(Genesis) (-c2)" $blocks "blocks"
+
+    measure ../blockdag -c3 -f blockdag.q -j $THREADS
+    report "batch sets (-c3)" $(wc -w < blockdag.q) "queries"
+
+    measure ../blockdag -c5 -f blockdag.q
+    report "reach pairs (-c5)" $(( $(wc -w < blockdag.q) / 2 )) "pairs"
+
+    if [ $blocks -le $CONE_MAX ]; then
+        measure ../blockdag -c9 -j $THREADS
+        report "cone sizes (-c9)" $blocks "blocks"
+    fi
+
+    measure ../blockdag -c8 blockdag.snap
+    report "save snapshot (-c8)" $blocks "blocks"
+
+    cp blockdag.snap blockdag.in
+    measure ../blockdag -c1
+    report "load snapshot (-c1)" $blocks "blocks"
+
+    echo
+done
+
+rm -f blockdag.in blockdag.out blockdag.q blockdag.snap bench.err bench.mem
@@ -6,6 +6,10 @@ VALGRIND="valgrind --leak-check=full --track-origins=yes -q --vgdb=no --log-file
 TESTS=("test0.in" "test0.in" "test1.in" "test1.in" "test2.in" "test2.in" "test3.in" "test3.in" "test4.in" "test4.in")
 NODES=("B" "H" "C" "D" "I" "E" "V3" "V5" "L" "C")
 KVALUES=(3 4 4 3 2 4 5 3 2 5)
+BATCHES=("B Genesis M" "H J K E" "C D I" "V3 V5 Genesis V14" "L A V U")
+APPENDS=(0 3 4)
+PRUNES=("H" "I" "F" "V6" "S" "A" "E" "E" "Nod3" "Node3")
+PAIRS=("B M M B Genesis J C L H J" "D K H I B J Genesis B E K" "C F F C D K B I G J" "V8 V1 V1 V8 V7 V5 V11 V3 V9 V2" "A V I S Q I B U T U" "A B B A")
 ############################################################################################################################
 
 # ANSI colors
@@ -30,7 +34,7 @@ function print_header {
 
 print_header "BLOCKCHAIN REGISTER"
 
-make build > /dev/null 2>&1
+make build gen > /dev/null 2>&1
 
 ############################################################################################################################
 
@@ -77,6 +81,11 @@ do
     diff $fileOut $fileRef > /dev/null
     EXIT_CODE=$?
 
+    # The same sets, searched level by level on several threads.
+    timeout 20 ./blockdag -c2 ${NODES[$i]} -j 4 > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
     if (( i < 10 )); then
         idx=" $i"
     else
@@ -93,6 +102,438 @@ done
 
 ############################################################################################################################
 
+echo -e "${BLUE}Batch Sets${NC}"
+for i in {0..4}
+do
+    fileIn="tests/test"$i".in"
+    fileOut="blockdag.out"
+    fileRef="tests/test"$i"_3.ref"
+    fileQuery="blockdag.q"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    # The same nodes, once from argv and once from a query file.
+    timeout 20 ./blockdag -c3 ${BATCHES[$i]} > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    echo ${BATCHES[$i]} > $fileQuery
+    rm $fileOut > /dev/null 2>&1
+    timeout 20 ./blockdag -c3 -f $fileQuery > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
+    # The answers must not depend on the number of threads.
+    rm $fileOut > /dev/null 2>&1
+    timeout 20 ./blockdag -c3 -j 4 -f $fileQuery > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Topological Order${NC}"
+for i in {0..9}
+do
+    fileIn="tests/test"$i".in"
+    fileRef="tests/test"$i"_4.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c4 > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Reachability${NC}"
+for i in {0..5}
+do
+    fileIn="tests/test"$i".in"
+    fileRef="tests/test"$i"_5.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c5 ${PAIRS[$i]} > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Append Blocks${NC}"
+for i in ${APPENDS[@]}
+do
+    fileIn="tests/test"$i".in"
+    fileBlocks="tests/test"$i"_6.in"
+    fileRef="tests/test"$i"_6.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c6 $fileBlocks > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}K-Cluster${NC}"
+for i in {0..9}
+do
+    fileIn="tests/"${TESTS[$i]}
+    fileRef="tests/test"$i"_7.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c7 ${KVALUES[$i]} > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Snapshot${NC}"
+for i in {0..9}
+do
+    fileIn="tests/"${TESTS[$i]}
+    fileRef="tests/test"$i"_2.ref"
+    fileOut="blockdag.out"
+
+    # Save the text graph, then answer the queries from the snapshot.
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut blockdag.snap > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c8 blockdag.snap > /dev/null 2>&1
+    cp blockdag.snap blockdag.in > /dev/null 2>&1
+    timeout 20 ./blockdag -c2 ${NODES[$i]} > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Cone Sizes${NC}"
+for i in {0..9}
+do
+    fileIn="tests/test"$i".in"
+    fileRef="tests/test"$i"_9.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c9 > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    rm $fileOut > /dev/null 2>&1
+    timeout 20 ./blockdag -c9 -j 4 > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}History Pruning${NC}"
+for i in {0..9}
+do
+    fileIn="tests/test"$i".in"
+    fileRef="tests/test"$i"_11.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c11 ${PRUNES[$i]} > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    # The kept blocks keep the cone sizes of the full history.
+    tail -n +2 $fileOut | grep -vxF -f "tests/test"$i"_9.ref" > /dev/null
+    [ $? -ne $ZERO ]
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Merge Sets${NC}"
+for i in ${APPENDS[@]}
+do
+    fileIn="tests/test"$i".in"
+    fileBlocks="tests/test"$i"_6.in"
+    fileRef="tests/test"$i"_12.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c12 3 $fileBlocks > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Linear Order${NC}"
+for i in {0..9}
+do
+    fileIn="tests/test"$i".in"
+    fileRef="tests/test"$i"_13.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    timeout 20 ./blockdag -c13 3 > /dev/null 2>&1
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Statistics${NC}"
+for i in {0..4}
+do
+    fileOut="blockdag.out"
+    fileRef="tests/test"$i"_3.ref"
+    fileStats="blockdag.stats"
+
+    cp "tests/test"$i".in" "blockdag.in"
+    rm $fileOut $fileStats > /dev/null 2>&1
+
+    # The report goes to stderr and leaves the results untouched.
+    timeout 20 ./blockdag -c3 ${BATCHES[$i]} --stats > /dev/null 2> $fileStats
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+    grep -q '"command":"-c3".*"phases":{"load":{.*"counters":{' $fileStats
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Parallel Load${NC}"
+COMMANDS=("-c4" "-c2 Genesis" "-c2 B99999")
+./gendag -n 100000 -s 7 -o blockdag.in > /dev/null 2>&1
+for i in {0..2}
+do
+    fileOut="blockdag.out"
+    fileRef="blockdag.ref"
+
+    # A graph of a few MB is split into chunks, the result must not change.
+    rm $fileOut $fileRef > /dev/null 2>&1
+    timeout 20 ./blockdag ${COMMANDS[$i]} -j 1 > /dev/null 2>&1
+    mv $fileOut $fileRef > /dev/null 2>&1
+    timeout 20 ./blockdag ${COMMANDS[$i]} -j 4 > /dev/null 2>&1
+    [ -s $fileRef ] && diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    rm $fileRef > /dev/null 2>&1
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Query Server${NC}"
+for i in {0..9}
+do
+    fileIn="tests/"${TESTS[$i]}
+    fileRef="tests/test"$i"_2.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    # The requests of -c2, answered line by line over stdin.
+    printf "past %s\nfuture %s\nanticone %s\ntips\n" ${NODES[$i]} ${NODES[$i]} ${NODES[$i]} | \
+        timeout 20 ./blockdag -c10 > $fileOut 2> /dev/null
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+for i in ${APPENDS[@]}
+do
+    fileIn="tests/test"$i".in"
+    fileReq="tests/test"$i"_10.in"
+    fileRef="tests/test"$i"_10.ref"
+    fileOut="blockdag.out"
+
+    cp "$fileIn" "blockdag.in"
+    rm $fileOut > /dev/null 2>&1
+
+    # Queries, appends, then queries over the appended blocks.
+    timeout 20 ./blockdag -c10 < $fileReq > $fileOut 2> /dev/null
+    diff $fileOut $fileRef > /dev/null
+    EXIT_CODE=$?
+
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
+echo -e "${BLUE}Output Option${NC}"
+for i in {0..4}
+do
+    fileOut="blockdag.out"
+    fileRef="tests/test"$i"_3.ref"
+    fileRes="blockdag.res"
+
+    cp "tests/test"$i".in" "blockdag.in"
+    rm $fileOut $fileRes > /dev/null 2>&1
+
+    # The results go to the named file, then to stdout, never to blockdag.out.
+    timeout 20 ./blockdag -o $fileRes -c3 ${BATCHES[$i]} > /dev/null 2>&1
+    diff $fileRes $fileRef > /dev/null
+    EXIT_CODE=$?
+    timeout 20 ./blockdag -c3 ${BATCHES[$i]} -o - 2> /dev/null | diff - $fileRef > /dev/null
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+    [ ! -e $fileOut ]
+    EXIT_CODE=$(( EXIT_CODE | $? ))
+
+    rm $fileRes > /dev/null 2>&1
+    idx=" $i"
+
+    if [ $EXIT_CODE -eq $ZERO ] 
+    then
+        echo -e "${ORANGE}Test $idx${GREEN} .......................................................... PASS${NC}"
+    else
+        echo -e "${ORANGE}Test $idx${RED} .......................................................... FAIL${NC}"
+    fi
+done
+
+############################################################################################################################
+
 echo -e "${BLUE}Valgrind Tests${NC}"
 fileIn="tests/test9.in"
 fileOut="blockdag.out"
@@ -1,12 +1,122 @@
 #include "./include/block_dag.h"
 
+#define QUERY_WINDOW 1024
+// Separators of the names of a query file, the same as the server requests
+// (whitespace, CRLF line ends, and the colon of "A : B" lines).
+#define QUERY_DELIM " :\t\r\n"
+
+// Number of threads running the bulk queries (-j N, 0 for all the cores, at most the cores).
+static int threads = 1;
+// Command of the run, for the statistics report (--stats).
+static char *command = NULL;
+// Path of the results (-o path, "-" for stdout).
+static const char *output = "blockdag.out";
+
+// Per-thread scratch of the set queries: the sets, the frontier of the
+// searches, the arena of the printed lists and the output of a window.
+typedef struct Worker {
+    BitSet *past;
+    BitSet *future;
+    BitSet *anticone;
+    Queue *queue;
+    Arena *arena;
+    Pool *pool;             // Threads of a single query, NULL for a queue based search.
+    Writer *out;            // Answers of the current window, kept in memory.
+} Worker;
+
+/**
+ * @brief Free the scratch of the workers.
+ * 
+ * @param workers The workers.
+ * @param count   The number of workers.
+ */
+void freeWorkers(Worker *workers, int count) {
+    if (!workers) return;
+
+    for (int w = 0; w < count; w++) {
+        Free_BitSet(workers[w].past);
+        Free_BitSet(workers[w].future);
+        Free_BitSet(workers[w].anticone);
+        Free_Queue(workers[w].queue);
+        Free_Arena(workers[w].arena);
+        Close_Writer(workers[w].out);
+    }
+
+    free(workers);
+}
+
+/**
+ * @brief Allocate the scratch of the workers, sized for the graph.
+ * 
+ * @param g     The loaded graph.
+ * @param count The number of workers.
+ * @return The workers, or NULL on failure.
+ */
+Worker* createWorkers(Graph *g, int count) {
+    Worker *workers = (Worker*)calloc(count, sizeof(Worker));
+    if (!workers) return NULL;
+
+    for (int w = 0; w < count; w++) {
+        workers[w].past = Create_BitSet(g->V);
+        workers[w].future = Create_BitSet(g->V);
+        workers[w].anticone = Create_BitSet(g->V);
+        workers[w].queue = Create_Queue(g->V);
+        workers[w].arena = Create_Arena(0);
+        workers[w].out = Create_Writer();
+
+        if (!workers[w].past || !workers[w].future || !workers[w].anticone ||
+            !workers[w].queue || !workers[w].arena || !workers[w].out) {
+            freeWorkers(workers, count);
+            return NULL;
+        }
+    }
+
+    return workers;
+}
+
+/**
+ * @brief Flush and close the results, failing the run if they were not all
+ * written (e.g. a full disk, or a closed pipe with -o -).
+ * 
+ * @param out The writer of the results.
+ */
+void closeOut(Writer *out) {
+    uint64_t start = Start_Stats();
+    bool written = Close_Writer(out);
+    Stop_Stats(PHASE_OUTPUT, start);
+
+    if (!written) {
+        fprintf(stderr, "Couldn't write results");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Load the graph of blockdag.in, its edge lines parsed by the threads
+ * of the run (-j N).
+ * 
+ * @return A pointer to the loaded graph, or NULL on failure.
+ */
+Graph* loadGraph(void) {
+    Pool *pool = threads > 1 ? Create_Pool(threads) : NULL;
+    Graph *g = Create_Graph(pool);
+    Free_Pool(pool);
+    return g;
+}
+
+/**
+ * @brief Write the statistics of the run to stderr (registered with atexit).
+ */
+void reportStats(void) {
+    Report_Stats(stderr, command);
+}
 
 /**
  * @brief Check the validity of the DAG and write the result to a file.
  */
 void checkValidDag(void) {
     // Create a new graph.
-    Graph *g = Create_Graph();
+    Graph *g = loadGraph();
 
     // Handle memory allocation failure.
     if (!g) {
@@ -15,10 +125,10 @@ void checkValidDag(void) {
     }
 
     // Open a file for writing results.
-    FILE *fout = fopen("blockdag.out", "w");
+    Writer *out = Open_Writer(output);
 
     // Handle opening file failure.
-    if (!fout) {
+    if (!out) {
         Free_Graph(g);
         fprintf(stderr, "Couldn't open file for writing");
         exit(EXIT_FAILURE);
@@ -29,12 +139,92 @@ void checkValidDag(void) {
 
     // Correct - graph is DAG.
     if (hasCycle)
-        fprintf(fout, "impossible\n");
+        Put_Str(out, "impossible\n");
     else
-        fprintf(fout, "correct\n");
+        Put_Str(out, "correct\n");
+
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Write a topological order of the DAG (parents first) to a file.
+ */
+void topoOrder(void) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        Free_Graph(g);
+        fprintf(stderr, "Couldn't open file for writing");
+        exit(EXIT_FAILURE);
+    }
 
+    int count = 0;
+    int *order = TopoSort(g, &count);
+
+    // Only a complete order is a valid one, otherwise there's a cycle.
+    if (!order || count < g->V) {
+        Put_Str(out, "impossible\n");
+    } else {
+        Put_Str(out, "topo(G) : ");
+        for (int pass = 0; pass < count; pass++) {
+            Put_Str(out, Get_ValNode(g, order[pass]));
+            Put_Char(out, ' ');
+        }
+        Put_Char(out, '\n');
+    }
+
+    free(order);
     Free_Graph(g);
-    fclose(fout);
+    closeOut(out);
+}
+
+/**
+ * @brief Write the past, future and anticone sets of a node to a writer.
+ * Only reads the graph (its transposed adjacency must be up to date), all
+ * the memory comes from the scratch of the worker. A worker with a pool
+ * searches level by level on it, for a single query on a large graph.
+ * 
+ * @param g    The loaded graph.
+ * @param w    The scratch of the calling worker.
+ * @param idx  The vertex index of the node.
+ * @param name The name of the node.
+ * @param out  The writer of the answers.
+ */
+void writeSets(Graph *g, Worker *w, int idx, char *name, Writer *out) {
+    Add_Stats(COUNT_QUERIES, 1);
+    bool found = w->pool ?
+        Past_Levels(g, w->pool, idx, w->past) && Future_Levels(g, w->pool, idx, w->future) :
+        Past_Into(g, idx, w->past, w->queue) && Future_Into(g, idx, w->future, w->queue);
+
+    // Empty lines would read as empty sets, fail the writer instead.
+    if (!found) {
+        fprintf(stderr, "Couldn't search the sets of %s", name);
+        out->failed = true;
+        return;
+    }
+
+    Anticone_Into(idx, w->past, w->future, w->anticone);
+
+    Put_Format(out, "past(%s) : ", name);
+    Write_Set(g, w->arena, w->past, out);
+
+    Put_Format(out, "future(%s) : ", name);
+    Write_Set(g, w->arena, w->future, out);
+
+    Put_Format(out, "anticone(%s) : ", name);
+    Write_Set(g, w->arena, w->anticone, out);
 }
 
 /**
@@ -44,7 +234,7 @@ void checkValidDag(void) {
  */
 void graphSets(char *name) {
     // Create a new graph.
-    Graph *g = Create_Graph();
+    Graph *g = loadGraph();
 
     // Handle memory allocation failure.
     if (!g) {
@@ -62,71 +252,1014 @@ void graphSets(char *name) {
     }
 
     // Open a file for writing results.
-    FILE *fout = fopen("blockdag.out", "w");
+    Writer *out = Open_Writer(output);
 
     // Handle opening file failure.
-    if (!fout) {
+    if (!out) {
         fprintf(stderr, "Couldn't open file for writing");
         Free_Graph(g);
         exit(EXIT_FAILURE);
     }
     
+    // The names are ranked once, every set is then ordered by rank.
+    Worker *workers = Refresh_TCSR(g) && Rank_Names(g) ? createWorkers(g, 1) : NULL;
+
+    // Handle memory allocation failure.
+    if (!workers) {
+        fprintf(stderr, "Couldn't allocate workers");
+        Free_Graph(g);
+        closeOut(out);
+        exit(EXIT_FAILURE);
+    }
+
+    // A single query gets all the threads.
+    workers->pool = Create_Pool(threads);
+
     // Retrieve and print: past, future, anticone, and tips sets.
-    ListVal *tips = Tips(g);
-    ListVal *past = Past(g, idx);
-    ListVal *future = Future(g, idx);
-    ListVal *anticone = Anticone(g, idx, past, future);
+    writeSets(g, workers, idx, name, out);
+    Free_Pool(workers->pool);
+    freeWorkers(workers, 1);
+
+    BitSet *tips = Tips(g);
+    Put_Str(out, "tips(G) : ");
+    Print_Set(g, tips, out);
+    Free_BitSet(tips);
+
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Read whitespace separated node names from a query file.
+ * 
+ * @param arena The arena holding the names.
+ * @param path  The path of the query file.
+ * @param count Where to store the number of names read.
+ * @return An array of names (to be freed by the caller, the names go
+ *         with the arena), or NULL on failure.
+ */
+char** readQueries(Arena *arena, char *path, int *count) {
+    FILE *fin = fopen(path, "r");
+
+    if (!fin) {
+        fprintf(stderr, "Couldn't open query file for reading");
+        return NULL;
+    }
+
+    size_t len = 0;
+    char *line = NULL;
+    int cap = 16;
+    char **names = (char**)malloc(cap * sizeof(char*));
+    *count = 0;
+
+    ssize_t read;
+    while (names && (read = getline(&line, &len, fin)) != -1) {
+        Add_Stats(COUNT_READ, (uint64_t)read);
+        for (char *tok = strtok(line, QUERY_DELIM); tok; tok = strtok(NULL, QUERY_DELIM)) {
+            // Grow the array of names when it is full.
+            if (*count == cap) {
+                char **grown = (char**)realloc(names, 2 * cap * sizeof(char*));
+                if (!grown) break;
+                names = grown;
+                cap *= 2;
+            }
+            names[*count] = Strndup_Arena(arena, tok, strlen(tok));
+            if (names[*count]) (*count)++;
+        }
+    }
+
+    if (!names)
+        fprintf(stderr, "Memory QUERIES allocation failed...");
+
+    fclose(fin);
+    free(line);
+    return names;
+}
+
+// Shared state of a window of batch queries, one query per pool item.
+typedef struct BatchJob {
+    Graph *g;               // The loaded graph (read only).
+    char **names;           // All the queried names.
+    int first;              // First query of the window.
+    Worker *workers;        // Scratch of every worker.
+    int *owner;             // Worker that answered each query, -1 if unknown.
+    size_t *start;          // Output span of each query in the writer of its worker.
+    size_t *end;
+} BatchJob;
+
+/**
+ * @brief Answer one query of a window into the writer of the worker.
+ * 
+ * @param ctx    The window (BatchJob).
+ * @param worker The worker answering the query.
+ * @param item   The index of the query in the window.
+ */
+static void batchQuery(void *ctx, int worker, int item) {
+    BatchJob *job = (BatchJob*)ctx;
+    Worker *w = &job->workers[worker];
+    char *name = job->names[job->first + item];
+    int idx = Get_IdxNode(job->g, name);
+
+    job->owner[item] = idx <= -1 ? -1 : worker;
+    if (idx <= -1) return;
+
+    job->start[item] = w->out->len;
+    writeSets(job->g, w, idx, name, w->out);
+    job->end[item] = w->out->len;
+}
+
+/**
+ * @brief Answer the sets of many nodes against one loaded graph.
+ * Each node gets its past, future and anticone lines, the tips follow once.
+ * The queries run on the thread pool, QUERY_WINDOW at a time: every worker
+ * writes to its own memory writer, then the answers of the window are copied
+ * to the results in input order, so the output does not depend on the threads.
+ * 
+ * @param count The number of nodes.
+ * @param names The names of the nodes.
+ */
+void batchSets(int count, char **names) {
+    // Create a new graph, shared by all the queries.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fprintf(stderr, "Couldn't open file for writing");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    // The queries only read the graph (and the ranks of its names) from here on.
+    Pool *pool = Refresh_TCSR(g) && Rank_Names(g) ? Create_Pool(threads) : NULL;
+    int size = pool ? pool->size : 1;
+    Worker *workers = pool ? createWorkers(g, size) : NULL;
+    BatchJob job = { g, names, 0, workers,
+                     (int*)malloc(QUERY_WINDOW * sizeof(int)),
+                     (size_t*)malloc(QUERY_WINDOW * sizeof(size_t)),
+                     (size_t*)malloc(QUERY_WINDOW * sizeof(size_t)) };
+
+    bool ok = workers && job.owner && job.start && job.end;
+
+    // Handle memory allocation failure.
+    if (!ok) fprintf(stderr, "Couldn't allocate workers");
+
+    for (job.first = 0; ok && job.first < count; job.first += QUERY_WINDOW) {
+        int n = count - job.first < QUERY_WINDOW ? count - job.first : QUERY_WINDOW;
+        bool filled = true;
+
+        Run_Pool(pool, n, batchQuery, &job);
+
+        for (int w = 0; w < size; w++)
+            filled = filled && !workers[w].out->failed;
+
+        uint64_t start = Start_Stats();
+        for (int q = 0; filled && q < n; q++) {
+            // Skip the nodes that don't exist.
+            if (job.owner[q] <= -1) {
+                fprintf(stderr, "Unknown node %s\n", names[job.first + q]);
+                continue;
+            }
+            Put_Bytes(out, workers[job.owner[q]].out->buf + job.start[q],
+                      job.end[q] - job.start[q]);
+        }
+        Stop_Stats(PHASE_OUTPUT, start);
+
+        for (int w = 0; w < size; w++)
+            Reset_Writer(workers[w].out);
+
+        if (!filled) {
+            fprintf(stderr, "Memory WRITER allocation failed...");
+            ok = false;
+        }
+    }
+
+    // The tips don't depend on the queried node, compute them once.
+    if (ok) {
+        BitSet *tips = Tips(g);
+        Put_Str(out, "tips(G) : ");
+        Print_Set(g, tips, out);
+        Free_BitSet(tips);
+    }
+
+    free(job.owner);
+    free(job.start);
+    free(job.end);
+    freeWorkers(workers, size);
+    Free_Pool(pool);
+    Free_Graph(g);
+
+    // A failed query leaves the results incomplete, fail the run.
+    if (!ok) {
+        Close_Writer(out);
+        exit(EXIT_FAILURE);
+    }
+
+    closeOut(out);
+}
+
+/**
+ * @brief Answer "is A in past(B)" for pairs of nodes with a reachability index.
+ * 
+ * @param count The number of node names (two per pair).
+ * @param names The node names, as consecutive (A, B) pairs.
+ */
+void reachPairs(int count, char **names) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fprintf(stderr, "Couldn't open file for writing");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    // The index is built once, every pair is then answered from it.
+    ReachIndex *ri = Create_Reach(g);
+
+    if (!ri) {
+        Put_Str(out, "impossible\n");
+    } else {
+        for (int q = 0; q + 1 < count; q += 2) {
+            int node = Get_IdxNode(g, names[q]);
+            int src = Get_IdxNode(g, names[q + 1]);
+
+            // Skip the pairs with nodes that don't exist.
+            if (node <= -1 || src <= -1) {
+                fprintf(stderr, "Unknown node %s\n", node <= -1 ? names[q] : names[q + 1]);
+                continue;
+            }
+
+            Put_Format(out, "%s in past(%s) : %s\n", names[q], names[q + 1],
+                       InPast(ri, src, node) ? "true" : "false");
+            Add_Stats(COUNT_QUERIES, 1);
+        }
+    }
+
+    Free_Reach(ri);
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Read the next block of a blocks file, one "Node : parents" line each,
+ * skipping the empty lines.
+ * 
+ * @param fin     The blocks file.
+ * @param line    The line buffer (getline), holding the names.
+ * @param len     The size of the line buffer.
+ * @param parents The parent names, grown as needed.
+ * @param cap     The number of parent slots.
+ * @param count   Where to store the number of parents.
+ * @return The name of the block, or NULL at the end of the file.
+ */
+char* readBlock(FILE *fin, char **line, size_t *len, char ***parents, int *cap, int *count) {
+    while (getline(line, len, fin) != -1) {
+        char *name = strtok(*line, DELIM_OPER);
+        if (!name) continue;
+
+        // Collect the parent names of the block.
+        *count = 0;
+        for (char *tok = strtok(NULL, DELIM_OPER); tok; tok = strtok(NULL, DELIM_OPER)) {
+            if (*count == *cap) {
+                char **grown = (char**)realloc(*parents, 2 * *cap * sizeof(char*));
+                if (!grown) break;
+                *parents = grown;
+                *cap *= 2;
+            }
+            (*parents)[(*count)++] = tok;
+        }
+        return name;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Append the blocks of a file, one "Node : parents" line each, to the
+ * loaded graph and write the tips after every accepted block.
+ * 
+ * @param path The path of the file with the new blocks.
+ */
+void appendBlocks(char *path) {
+    FILE *fin = fopen(path, "r");
+
+    if (!fin) {
+        fprintf(stderr, "Couldn't open blocks file for reading");
+        exit(EXIT_FAILURE);
+    }
+
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fclose(fin);
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fclose(fin);
+        Free_Graph(g);
+        fprintf(stderr, "Couldn't open file for writing");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t len = 0;
+    char *line = NULL, *name;
+    int cap = 16, count = 0;
+    char **parents = (char**)malloc(cap * sizeof(char*));
+
+    while (parents && (name = readBlock(fin, &line, &len, &parents, &cap, &count))) {
+        if (Append_Block(g, name, parents, count) <= -1) {
+            fprintf(stderr, "Rejected block %s\n", name);
+            continue;
+        }
+
+        Put_Str(out, "tips(G) : ");
+        Print_Set(g, g->tips, out);
+    }
+
+    if (!parents)
+        fprintf(stderr, "Memory PARENTS allocation failed...");
+
+    free(parents);
+    free(line);
+    fclose(fin);
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Append the blocks of a file, one "Node : parents" line each, to the
+ * loaded graph colored by GHOSTDAG, and write the merge set of every accepted
+ * block: its selected parent first, then the rest in GHOSTDAG order. Each new
+ * block is labeled and colored on its own, walking only its merge set.
+ * 
+ * @param k    The maximum anticone size of a blue block.
+ * @param path The path of the file with the new blocks.
+ */
+void mergeSets(int k, char *path) {
+    FILE *fin = fopen(path, "r");
+
+    if (!fin) {
+        fprintf(stderr, "Couldn't open blocks file for reading");
+        exit(EXIT_FAILURE);
+    }
+
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fclose(fin);
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fclose(fin);
+        Free_Graph(g);
+        fprintf(stderr, "Couldn't open file for writing");
+        exit(EXIT_FAILURE);
+    }
+
+    // A cycle is an answer, a failed allocation is an error.
+    bool cyclic = HasCycle(g);
+    ReachIndex *ri = !cyclic && Rank_Names(g) ? Create_Reach(g) : NULL;
+    GhostDag *gd = ri ? Create_GhostDag(g, ri, k) : NULL;
+
+    size_t len = 0;
+    char *line = NULL, *name;
+    int cap = 16, count = 0;
+    char **parents = (char**)malloc(cap * sizeof(char*));
+    bool ok = cyclic || (gd && parents);
+
+    if (!cyclic && !gd) fprintf(stderr, "Couldn't allocate GHOSTDAG");
+    if (!parents) fprintf(stderr, "Memory PARENTS allocation failed...");
+    if (cyclic) Put_Str(out, "impossible\n");
+
+    while (gd && parents && (name = readBlock(fin, &line, &len, &parents, &cap, &count))) {
+        int v = Append_Block(g, name, parents, count);
+
+        if (v <= -1) {
+            fprintf(stderr, "Rejected block %s\n", name);
+            continue;
+        }
+
+        int *merge = NULL;
+        int size = Extend_Reach(ri) && Extend_GhostDag(gd) ? Get_MergeSet(gd, v, &merge) : -1;
+
+        if (size <= -1) {
+            fprintf(stderr, "Couldn't color block %s\n", name);
+            ok = false;
+            break;
+        }
+
+        Put_Str(out, "merge_set(");
+        Put_Str(out, name);
+        Put_Str(out, ") : ");
+        if (gd->selParent[v] != -1) {
+            Put_Str(out, Get_ValNode(g, gd->selParent[v]));
+            Put_Char(out, ' ');
+        }
+        for (int m = 0; m < size; m++) {
+            Put_Str(out, Get_ValNode(g, merge[m]));
+            Put_Char(out, ' ');
+        }
+        Put_Char(out, '\n');
+    }
+
+    free(parents);
+    free(line);
+    fclose(fin);
+    Free_GhostDag(gd);
+    Free_Reach(ri);
+    Free_Graph(g);
+
+    if (!ok) {
+        Close_Writer(out);
+        exit(EXIT_FAILURE);
+    }
+
+    closeOut(out);
+}
+
+/**
+ * @brief Write the GHOSTDAG blue set, red set and blue scores for a given k.
+ * 
+ * @param k The maximum anticone size of a blue block.
+ */
+void kCluster(int k) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fprintf(stderr, "Couldn't open file for writing");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    // A cycle is an answer, a failed allocation is an error.
+    bool cyclic = HasCycle(g);
+    ReachIndex *ri = !cyclic && Rank_Names(g) ? Create_Reach(g) : NULL;
+    GhostDag *gd = ri ? Create_GhostDag(g, ri, k) : NULL;
+
+    if (!cyclic && !gd) {
+        fprintf(stderr, "Couldn't allocate GHOSTDAG");
+        Free_Reach(ri);
+        Free_Graph(g);
+        Close_Writer(out);
+        exit(EXIT_FAILURE);
+    }
+
+    if (cyclic) {
+        Put_Str(out, "impossible\n");
+    } else {
+        Put_Str(out, "blues(G) : ");
+        Print_Set(g, gd->blueSet, out);
+
+        BitSet *reds = Copy_BitSet(gd->blueSet);
+        if (reds) Complement_BitSet(reds);
+        Put_Str(out, "reds(G) : ");
+        Print_Set(g, reds, out);
+        Free_BitSet(reds);
+
+        // Blue scores of the blocks in list order, then of the whole graph.
+        for (int r = 0; r < g->V; r++) {
+            int v = g->byRank[r];
+            Put_Str(out, "blue_score(");
+            Put_Bytes(out, g->idxMap[v], g->nameLen[v]);
+            Put_Str(out, ") : ");
+            Put_Int(out, gd->blueScore[v]);
+            Put_Char(out, '\n');
+        }
+        Put_Format(out, "blue_score(G) : %d\n", gd->blueScore[g->V]);
+    }
+
+    Free_GhostDag(gd);
+    Free_Reach(ri);
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Write the consensus order of the whole graph for a given k (the
+ * merge sets along the GHOSTDAG virtual chain), or impossible if the graph
+ * has a cycle.
+ * 
+ * @param k The maximum anticone size of a blue block.
+ */
+void linearOrder(int k) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fprintf(stderr, "Couldn't open file for writing");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    // A cycle is an answer, a failed allocation is an error.
+    bool cyclic = HasCycle(g);
+    ReachIndex *ri = !cyclic && Rank_Names(g) ? Create_Reach(g) : NULL;
+    GhostDag *gd = ri ? Create_GhostDag(g, ri, k) : NULL;
+
+    if (!cyclic && !gd) {
+        fprintf(stderr, "Couldn't allocate GHOSTDAG");
+        Free_Reach(ri);
+        Free_Graph(g);
+        Close_Writer(out);
+        exit(EXIT_FAILURE);
+    }
+
+    if (cyclic) {
+        Put_Str(out, "impossible\n");
+    } else {
+        Put_Str(out, "order(G) : ");
+        if (!Write_Order(gd, out)) {
+            fprintf(stderr, "Couldn't order the graph");
+            Free_GhostDag(gd);
+            Free_Reach(ri);
+            Free_Graph(g);
+            Close_Writer(out);
+            exit(EXIT_FAILURE);
+        }
+        Put_Char(out, '\n');
+    }
+
+    Free_GhostDag(gd);
+    Free_Reach(ri);
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Write the sizes of past, future and anticone of every block, in
+ * the order of the names line, one "sizes(X) : ..." line each.
+ * 
+ * @param g        The graph.
+ * @param past     The past sizes of the blocks.
+ * @param future   The future sizes of the blocks.
+ * @param anticone The anticone sizes of the blocks.
+ * @param out      The writer of the results.
+ */
+void writeSizes(Graph *g, int *past, int *future, int *anticone, Writer *out) {
+    for (int v = 0; v < g->V; v++) {
+        Put_Str(out, "sizes(");
+        Put_Str(out, Get_ValNode(g, v));
+        Put_Str(out, ") : past ");
+        Put_Int(out, past[v]);
+        Put_Str(out, " future ");
+        Put_Int(out, future[v]);
+        Put_Str(out, " anticone ");
+        Put_Int(out, anticone[v]);
+        Put_Char(out, '\n');
+    }
+}
+
+/**
+ * @brief Write the sizes of past, future and anticone of every block,
+ * in the order of the names line, or impossible if the graph has a cycle.
+ */
+void coneSizes(void) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fprintf(stderr, "Couldn't open file for writing");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    int V = g->V ? g->V : 1;
+    int *past = (int*)malloc(V * sizeof(int));
+    int *future = (int*)malloc(V * sizeof(int));
+    int *anticone = (int*)malloc(V * sizeof(int));
+
+    Pool *pool = Create_Pool(threads);
+
+    if (!past || !future || !anticone || !Cone_Sizes(g, pool, past, future, anticone)) {
+        Put_Str(out, "impossible\n");
+    } else {
+        writeSizes(g, past, future, anticone, out);
+    }
+
+    free(past);
+    free(future);
+    free(anticone);
+    Free_Pool(pool);
+    Free_Graph(g);
+    closeOut(out);
+}
+
+/**
+ * @brief Prune the finalized history behind a block, then write the number
+ * of pruned blocks and the sizes of past, future and anticone of every kept
+ * block (those of the full history), or impossible if the graph has a cycle.
+ * 
+ * @param name The name of the pruning point.
+ */
+void prunePast(char *name) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    int point = Get_IdxNode(g, name);
+
+    // Handle an unknown pruning point.
+    if (point <= -1) {
+        fprintf(stderr, "Unknown pruning point");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    // Open a file for writing results.
+    Writer *out = Open_Writer(output);
+
+    // Handle opening file failure.
+    if (!out) {
+        fprintf(stderr, "Couldn't open file for writing");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    // A cycle is an answer, a failed prune or count is an error.
+    if (HasCycle(g)) {
+        Put_Str(out, "impossible\n");
+        Free_Graph(g);
+        closeOut(out);
+        return;
+    }
+
+    int pruned = Prune_Past(g, point);
+    int V = g->V ? g->V : 1;
+    int *past = (int*)malloc(V * sizeof(int));
+    int *future = (int*)malloc(V * sizeof(int));
+    int *anticone = (int*)malloc(V * sizeof(int));
+
+    Pool *pool = Create_Pool(threads);
+    bool ok = pruned >= 0 && past && future && anticone &&
+              Cone_Sizes(g, pool, past, future, anticone);
+
+    if (ok) {
+        Put_Format(out, "pruned(G) : %d\n", pruned);
+        writeSizes(g, past, future, anticone, out);
+    }
+
+    free(past);
+    free(future);
+    free(anticone);
+    Free_Pool(pool);
+    Free_Graph(g);
+
+    if (!ok) {
+        fprintf(stderr, "Couldn't prune the graph");
+        Close_Writer(out);
+        exit(EXIT_FAILURE);
+    }
+
+    closeOut(out);
+}
+
+/**
+ * @brief Save the graph read from blockdag.in to a binary snapshot, which
+ * later runs load by mapping it (copied or renamed to blockdag.in).
+ * 
+ * @param path The path of the snapshot file.
+ */
+void saveSnapshot(char *path) {
+    // Create a new graph.
+    Graph *g = loadGraph();
+
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
+
+    if (!Save_Snapshot(g, path)) {
+        fprintf(stderr, "Couldn't write snapshot");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
+
+    Free_Graph(g);
+}
+
+/**
+ * @brief Load the graph once and answer requests until the input ends (stdin
+ * and stdout) or the server is stopped (a Unix socket, one thread for every
+ * connection). See Serve_Line for the requests.
+ * 
+ * @param path The path of the socket, NULL for stdin and stdout.
+ */
+void serveQueries(char *path) {
+    // Create a new graph, shared by all the connections.
+    Graph *g = loadGraph();
 
-    fprintf(fout, "past(%s) : ", name);
-    Print_Ord(past, fout);
-    Free_Ord(past);
+    // Handle memory allocation failure.
+    if (!g) {
+        fprintf(stderr, "Couldn't allocate g");
+        exit(EXIT_FAILURE);
+    }
 
-    fprintf(fout, "future(%s) : ", name);
-    Print_Ord(future, fout);
-    Free_Ord(future);
+    Server *s = Create_Server(g);
 
-    fprintf(fout, "anticone(%s) : ", name);
-    Print_Ord(anticone, fout);
-    Free_Ord(anticone);
+    if (!s) {
+        fprintf(stderr, "Couldn't start the server");
+        Free_Graph(g);
+        exit(EXIT_FAILURE);
+    }
 
-    fprintf(fout, "tips(G) : ");
-    Print_Ord(tips, fout);
-    Free_Ord(tips);
+    bool served = path ? Serve_Socket(s, path) : Serve_Stream(s, STDIN_FILENO, STDOUT_FILENO);
 
+    Free_Server(s);
     Free_Graph(g);
-    fclose(fout);
+    if (!served) exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Check that a command-line argument is a non-negative number that
+ * fits an int (at most 9 digits).
+ * 
+ * @param arg The argument.
+ * @return true if it is made of 1 to 9 digits.
+ */
+bool isNumber(const char *arg) {
+    size_t len = strlen(arg);
+    return len && len <= 9 && strspn(arg, "0123456789") == len;
 }
 
 int main(int argc, char **argv) {
-    // Handle too many / missing command(s).
-    if (argc > 3) {
-        fprintf(stderr, "Too many command-line arguments");
+    // Handle missing command.
+    if (argc < 2) {
+        fprintf(stderr, "Missing command");
         return EXIT_FAILURE;
     }
+
+    // Take the options (-j N, -o path, --stats) out of the arguments, wherever they are.
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--stats")) {
+            // Report the phases and counters of the run as JSON on stderr.
+            Enable_Stats();
+            atexit(reportStats);
+            for (int b = a; b + 1 <= argc; b++)
+                argv[b] = argv[b + 1];
+            argc--;
+            a--;
+            continue;
+        }
+        if (!strcmp(argv[a], "-o")) {
+            // Write the results to another file, or to stdout with "-".
+            if (a + 1 >= argc || !argv[a + 1][0]) {
+                fprintf(stderr, "Missing path for -o option");
+                return EXIT_FAILURE;
+            }
+            output = argv[a + 1];
+            for (int b = a; b + 2 <= argc; b++)
+                argv[b] = argv[b + 2];
+            argc -= 2;
+            a--;
+            continue;
+        }
+        if (strcmp(argv[a], "-j")) continue;
+        const char *arg = a + 1 < argc ? argv[a + 1] : "";
+        errno = 0;
+        long n = strtol(arg, NULL, 10);
+        if (!arg[0] || strspn(arg, "0123456789") != strlen(arg) || errno || n > POOL_MAX_SIZE) {
+            fprintf(stderr, "Invalid number of threads for -j option");
+            return EXIT_FAILURE;
+        }
+        // More workers than cores only add threads and per-worker scratch.
+        threads = !n || n > Cores_Pool() ? Cores_Pool() : (int)n;
+        for (int b = a; b + 2 <= argc; b++)
+            argv[b] = argv[b + 2];
+        argc -= 2;
+        a--;
+    }
+
+    // Handle missing command.
     if (argc < 2) {
         fprintf(stderr, "Missing command");
         return EXIT_FAILURE;
     }
 
     char *cmd = argv[1];
+    command = cmd;
+
+    // Commands are -c followed by their number (-c1 ... -c13).
+    bool numbered = !strncmp(cmd, "-c", 2) && cmd[2] && strspn(cmd + 2, "0123456789") == strlen(cmd + 2);
 
-    switch (cmd[1]) {
-        case 'c':
-            switch (cmd[2]) {
-                case '1':
-                    checkValidDag();
-                    break;
-                case '2':
-                    if (argc != 3) {
-                        fprintf(stderr, "Invalid number of arguments for -c2 command");
-                        return EXIT_FAILURE;
-                    }
-                    graphSets(argv[2]);
-                    break;
-                default:
-                    fprintf(stderr, "Unknown command...");
+    switch (numbered ? atoi(cmd + 2) : 0) {
+        case 1:
+            if (argc > 3) {
+                fprintf(stderr, "Too many command-line arguments");
+                return EXIT_FAILURE;
+            }
+            checkValidDag();
+            break;
+        case 2:
+            if (argc != 3) {
+                fprintf(stderr, "Invalid number of arguments for -c2 command");
+                return EXIT_FAILURE;
+            }
+            graphSets(argv[2]);
+            break;
+        case 3:
+            if (argc < 3) {
+                fprintf(stderr, "Invalid number of arguments for -c3 command");
+                return EXIT_FAILURE;
+            }
+            // Node names from a query file, or straight from argv.
+            if (!strcmp(argv[2], "-f")) {
+                if (argc != 4) {
+                    fprintf(stderr, "Invalid number of arguments for -c3 -f command");
                     return EXIT_FAILURE;
+                }
+                int count = 0;
+                Arena *arena = Create_Arena(0);
+                char **names = arena ? readQueries(arena, argv[3], &count) : NULL;
+                if (!names) {
+                    Free_Arena(arena);
+                    return EXIT_FAILURE;
+                }
+                batchSets(count, names);
+                free(names);
+                Free_Arena(arena);
+            } else {
+                batchSets(argc - 2, &argv[2]);
+            }
+            break;
+        case 4:
+            if (argc > 2) {
+                fprintf(stderr, "Too many command-line arguments");
+                return EXIT_FAILURE;
+            }
+            topoOrder();
+            break;
+        case 5:
+            if (argc < 3) {
+                fprintf(stderr, "Invalid number of arguments for -c5 command");
+                return EXIT_FAILURE;
+            }
+            // Node pairs from a query file, or straight from argv.
+            if (!strcmp(argv[2], "-f")) {
+                if (argc != 4) {
+                    fprintf(stderr, "Invalid number of arguments for -c5 -f command");
+                    return EXIT_FAILURE;
+                }
+                int count = 0;
+                Arena *arena = Create_Arena(0);
+                char **names = arena ? readQueries(arena, argv[3], &count) : NULL;
+                if (!names) {
+                    Free_Arena(arena);
+                    return EXIT_FAILURE;
+                }
+                if (count % 2) {
+                    fprintf(stderr, "Odd number of names for -c5 -f command");
+                    free(names);
+                    Free_Arena(arena);
+                    return EXIT_FAILURE;
+                }
+                reachPairs(count, names);
+                free(names);
+                Free_Arena(arena);
+            } else if ((argc - 2) % 2) {
+                fprintf(stderr, "Odd number of names for -c5 command");
+                return EXIT_FAILURE;
+            } else {
+                reachPairs(argc - 2, &argv[2]);
+            }
+            break;
+        case 6:
+            if (argc != 3) {
+                fprintf(stderr, "Invalid number of arguments for -c6 command");
+                return EXIT_FAILURE;
+            }
+            appendBlocks(argv[2]);
+            break;
+        case 7:
+            if (argc != 3) {
+                fprintf(stderr, "Invalid number of arguments for -c7 command");
+                return EXIT_FAILURE;
+            }
+            if (!isNumber(argv[2])) {
+                fprintf(stderr, "Invalid k for -c7 command");
+                return EXIT_FAILURE;
+            }
+            kCluster(atoi(argv[2]));
+            break;
+        case 8:
+            if (argc != 3) {
+                fprintf(stderr, "Invalid number of arguments for -c8 command");
+                return EXIT_FAILURE;
+            }
+            saveSnapshot(argv[2]);
+            break;
+        case 9:
+            if (argc > 2) {
+                fprintf(stderr, "Too many command-line arguments");
+                return EXIT_FAILURE;
+            }
+            coneSizes();
+            break;
+        case 10:
+            if (argc > 3) {
+                fprintf(stderr, "Too many command-line arguments");
+                return EXIT_FAILURE;
+            }
+            serveQueries(argc == 3 ? argv[2] : NULL);
+            break;
+        case 11:
+            if (argc != 3) {
+                fprintf(stderr, "Invalid number of arguments for -c11 command");
+                return EXIT_FAILURE;
+            }
+            prunePast(argv[2]);
+            break;
+        case 12:
+            if (argc != 4) {
+                fprintf(stderr, "Invalid number of arguments for -c12 command");
+                return EXIT_FAILURE;
+            }
+            if (!isNumber(argv[2])) {
+                fprintf(stderr, "Invalid k for -c12 command");
+                return EXIT_FAILURE;
+            }
+            mergeSets(atoi(argv[2]), argv[3]);
+            break;
+        case 13:
+            if (argc != 3) {
+                fprintf(stderr, "Invalid number of arguments for -c13 command");
+                return EXIT_FAILURE;
+            }
+            if (!isNumber(argv[2])) {
+                fprintf(stderr, "Invalid k for -c13 command");
+                return EXIT_FAILURE;
             }
+            linearOrder(atoi(argv[2]));
             break;
         default:
             fprintf(stderr, "Unknown command...");
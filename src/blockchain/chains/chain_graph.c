@@ -1,127 +1,355 @@
 #include "../include/chain_graph.h"
 
 /**
- * @brief Perform Breadth-First Search (BFS) on the graph starting from a source node.
+ * @brief Perform Breadth-First Search (BFS) on the graph starting from a source node,
+ * into caller owned buffers, so repeated searches (one per thread) allocate nothing.
+ * Only reads the graph, the adjacency must be up to date.
  * 
  * @param g     A pointer to the graph.
+ * @param adj   The adjacency to follow (forward or transposed).
  * @param src   The index of the source node.
- * @return      A list of values visited during BFS, or NULL on failure.
+ * @param vis   The set of nodes visited during BFS (without src), over [0, V).
+ * @param queue The frontier, left empty.
+ * @return      true on success, false on failure.
  */
-ListVal* Path_Vis(Graph *g, int src) {
-    if (!g || !g->adjList || !g->idxMap) return NULL;
-
-    // Create a queue for BFS traversal.
-    Queue *queue = Create_Queue();
-    if (!queue) return NULL;
-
-    // Initialize an array to track visited nodes.
-    bool *vis = (bool*)calloc(g->V, sizeof(bool));
+bool Path_Into(Graph *g, AdjCSR *adj, int src, BitSet *vis, Queue *queue) {
+    if (!g || !adj || !adj->offset || !vis || !queue) return false;
 
-    if (!vis) {
-        fprintf(stderr, "ERROR: Memory VIS allocation failed...");
-        Free_Queue(queue);
-        return NULL;
-    }
+    // The visited set is also the resulting path.
+    uint64_t start = Start_Stats(), nodes = 0, edges = 0;
+    Clear_BitSet(vis);
+    Clear_Queue(queue);
 
     Enqueue(queue, src);  // Enqueue the source node.
-    vis[src] = true;      // Mark the source node as visited.
-    ListVal* path = NULL; // Initialize the list of visited nodes.
+    Set_Bit(vis, src);    // Mark the source node as visited.
 
     while (!IsEmpty_Queue(queue)) {
         int node = Front(queue);  // Get the front node from the queue.
         Dequeue(queue);           // Dequeue the front node.
+        nodes++;
+        edges += adj->offset[node + 1] - adj->offset[node];
 
-        // Add the node to the visited list if not the source node.
-        if (node != src) {
-            path = Insert_Ord(path, Get_ValNode(g, node));
+        // Walk the adjacent nodes of the current node (CSR row).
+        for (int e = adj->offset[node]; e < adj->offset[node + 1]; e++) {
+            int neighbor = adj->adj[e];
+            // Mark the neighbor node as visited.
+            if (!Test_Bit(vis, neighbor)) {
+                Set_Bit(vis, neighbor);
+                if (!Enqueue(queue, neighbor))    // Enqueue the neighbor node.
+                    return false;
+            }
         }
+    }
 
-        // Get the adjacent nodes of the current node.
-        GraphNode* srcNode = g->adjList[node];
+    // The source node is not part of its own path.
+    Clear_Bit(vis, src);
+    Stop_Stats(PHASE_SEARCH, start);
+    Add_Stats(COUNT_NODES, nodes);
+    Add_Stats(COUNT_EDGES, edges);
+    return true;
+}
 
-        while (srcNode) {
-            // Get the index of the neighbor node.
-            int neighbor = Get_IdxNode(g, srcNode->name);
-            // Mark the neighbor node as visited.
-            if (!vis[neighbor]) {
-                vis[neighbor] = true;        
-                Enqueue(queue, neighbor);    // Enqueue the neighbor node.
+/**
+ * @brief Perform Breadth-First Search (BFS) on the graph starting from a source node.
+ * 
+ * @param g     A pointer to the graph.
+ * @param adj   The adjacency to follow (forward or transposed).
+ * @param src   The index of the source node.
+ * @return      The set of nodes visited during BFS (without src), or NULL on failure.
+ */
+BitSet* Path_Vis(Graph *g, AdjCSR *adj, int src) {
+    if (!g || !adj || !adj->offset || !g->idxMap) return NULL;
+
+    // Create a queue for BFS traversal, every node is enqueued at most once.
+    Queue *queue = Create_Queue(g->V);
+    BitSet *vis = Create_BitSet(g->V);
+
+    if (!queue || !vis || !Path_Into(g, adj, src, vis, queue)) {
+        if (queue && !vis) fprintf(stderr, "ERROR: Memory VIS allocation failed...");
+        Free_Queue(queue);
+        Free_BitSet(vis);
+        return NULL;
+    }
+
+    Free_Queue(queue);
+    return vis;
+}
+
+// State of a level-synchronous search, shared by the workers of a level.
+typedef struct LevelJob {
+    AdjCSR *adj;            // Adjacency searched (top-down levels).
+    AdjCSR *rev;            // Its transpose (bottom-up levels).
+    BitSet *vis;            // Visited set (set atomically in top-down levels).
+    BitSet *front;          // Frontier of a bottom-up level.
+    BitSet *next;           // Next frontier of a bottom-up level.
+    int *queue;             // Frontier of a top-down level.
+    int *out;               // Next frontier of a top-down level.
+    int size;               // Nodes in the frontier.
+    int tail;               // Nodes in the next frontier (atomic).
+    long edges;             // Edges out of the next frontier (atomic).
+    long scanned;           // Edges looked at by the whole search (atomic).
+} LevelJob;
+
+/**
+ * @brief Append nodes found by a worker to the next top-down frontier.
+ * 
+ * @param job   The search.
+ * @param found The nodes.
+ * @param count The number of nodes.
+ */
+static void Flush_Level(LevelJob *job, int *found, int count) {
+    int pos = __atomic_fetch_add(&job->tail, count, __ATOMIC_RELAXED);
+    memcpy(job->out + pos, found, count * sizeof(int));
+}
+
+/**
+ * @brief Top-down step over a chunk of the frontier: claim the unvisited
+ * neighbors with an atomic OR on the visited words.
+ * 
+ * @param ctx    The search (LevelJob).
+ * @param worker The worker (unused, the state is per item).
+ * @param item   The chunk of BFS_GRAIN frontier nodes.
+ */
+static void Top_Down(void *ctx, int worker, int item) {
+    (void)worker;
+    LevelJob *job = (LevelJob*)ctx;
+    AdjCSR *adj = job->adj;
+    uint64_t *vis = job->vis->bits;
+    int found[BFS_FLUSH], count = 0;
+    long edges = 0, scanned = 0;
+
+    int end = (item + 1) * BFS_GRAIN < job->size ? (item + 1) * BFS_GRAIN : job->size;
+    for (int i = item * BFS_GRAIN; i < end; i++) {
+        int node = job->queue[i];
+        scanned += adj->offset[node + 1] - adj->offset[node];
+        for (int e = adj->offset[node]; e < adj->offset[node + 1]; e++) {
+            int neighbor = adj->adj[e];
+            uint64_t mask = 1ULL << (neighbor % BITS_PER_WORD);
+            uint64_t *word = &vis[neighbor / BITS_PER_WORD];
+
+            // Cheap check first, the OR decides between racing workers.
+            if (__atomic_load_n(word, __ATOMIC_RELAXED) & mask) continue;
+            if (__atomic_fetch_or(word, mask, __ATOMIC_RELAXED) & mask) continue;
+
+            found[count++] = neighbor;
+            edges += adj->offset[neighbor + 1] - adj->offset[neighbor];
+            if (count == BFS_FLUSH) {
+                Flush_Level(job, found, count);
+                count = 0;
             }
-            srcNode = srcNode->next;  // Move to the next adjacent node.
         }
     }
 
-    free(vis);
-    Free_Queue(queue);
-    return path;
+    if (count) Flush_Level(job, found, count);
+    __atomic_fetch_add(&job->edges, edges, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->scanned, scanned, __ATOMIC_RELAXED);
 }
 
 /**
- * @brief Recursively checks for a cycle in the graph using depth-first search (DFS).
+ * @brief Bottom-up step over a range of visited words: every unvisited node
+ * looks for a neighbor in the frontier along the transposed adjacency.
+ * Each item owns its words, so no atomics are needed on the sets.
  * 
- * @param g     A pointer to the graph.
- * @param src   The current source node index.
- * @param vis   An array to track visited nodes.
- * @param stack An array to track nodes in the current recursion stack.
- * @return true if a cycle is found, false otherwise.
+ * @param ctx    The search (LevelJob).
+ * @param worker The worker (unused, the state is per item).
+ * @param item   The range of BFS_WORDS words.
  */
-bool TopoSort(Graph *g, int src, bool *vis, bool *stack) {
-    if (!g || !g->adjList || !g->idxMap) return false;
-    // If the node is in the current stack, a cycle is detected.
-    if (stack[src]) return true;
-    // If the node is already visited and not in the stack, no cycle.
-    if (vis[src]) return false;
-
-    vis[src] = true;       // Mark the node as visited.
-    stack[src] = true;     // Mark the node as part of the current recursion stack.
-    GraphNode* srcNode = g->adjList[src];  // Get the adjacent nodes of the current node.
-
-    while (srcNode) {
-        // Get the index of the neighbor node.
-        int neighbor = Get_IdxNode(g, srcNode->name);
-        // Recursively check the neighbor nodes for cycles.
-        if (TopoSort(g, neighbor, vis, stack)) {
-            return true;
+static void Bottom_Up(void *ctx, int worker, int item) {
+    (void)worker;
+    LevelJob *job = (LevelJob*)ctx;
+    AdjCSR *adj = job->adj, *rev = job->rev;
+    BitSet *vis = job->vis;
+    uint64_t *front = job->front->bits;
+    int count = 0;
+    long edges = 0, scanned = 0;
+
+    int end = (item + 1) * BFS_WORDS < vis->words ? (item + 1) * BFS_WORDS : vis->words;
+    for (int w = item * BFS_WORDS; w < end; w++) {
+        uint64_t todo = ~vis->bits[w], found = 0;
+        // The tail of the last word is not part of the universe.
+        if (w == vis->words - 1 && vis->n % BITS_PER_WORD)
+            todo &= (1ULL << (vis->n % BITS_PER_WORD)) - 1;
+
+        while (todo) {
+            int bit = __builtin_ctzll(todo);
+            int node = w * BITS_PER_WORD + bit;
+            todo &= todo - 1;
+
+            for (int e = rev->offset[node]; e < rev->offset[node + 1]; e++) {
+                int prev = rev->adj[e];
+                scanned++;
+                if (front[prev / BITS_PER_WORD] >> (prev % BITS_PER_WORD) & 1) {
+                    found |= 1ULL << bit;
+                    edges += adj->offset[node + 1] - adj->offset[node];
+                    break;
+                }
+            }
         }
-        srcNode = srcNode->next;  // Move to the next adjacent node
+
+        job->next->bits[w] = found;
+        vis->bits[w] |= found;
+        count += __builtin_popcountll(found);
     }
 
-    // If the recursion stack is unwound, mark the node as not in the stack.
-    stack[src] = false;
-    // No cycle found in this branch.
-    return false;
+    __atomic_fetch_add(&job->tail, count, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->edges, edges, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->scanned, scanned, __ATOMIC_RELAXED);
 }
 
 /**
- * @brief Checks if the graph has a cycle using topological sorting.
+ * @brief Level-synchronous, direction-optimizing BFS (Beamer) on a pool.
+ * Small frontiers are expanded top-down, each level split in chunks across
+ * the workers. Once the edges out of the frontier outweigh the unexplored
+ * ones (BFS_ALPHA), levels go bottom-up: every unvisited node checks its
+ * transposed row against the frontier bitmap, until the frontier shrinks
+ * below V / BFS_BETA. Levels of a single chunk run on the calling thread.
  * 
- * @param g A pointer to the graph.
- * @return true if the graph has a cycle, false otherwise.
+ * @param g    A pointer to the graph.
+ * @param adj  The adjacency to follow (forward or transposed).
+ * @param rev  The transpose of adj, up to date.
+ * @param src  The index of the source node.
+ * @param vis  The set of nodes visited (without src), over [0, V).
+ * @param pool The workers (NULL searches on the calling thread).
+ * @return true on success, false on failure.
  */
-bool HasCycle(Graph *g) {
-    if (!g || !g->adjList || !g->idxMap) return false;
+bool Path_Levels(Graph *g, AdjCSR *adj, AdjCSR *rev, int src, BitSet *vis, Pool *pool) {
+    if (!g || !adj || !adj->offset || !rev || !rev->offset || !vis) return false;
+    if (src < 0 || src >= g->V) return false;
 
-    // Initialize array for visited, and nodes that are in recursion stack.
-    bool* vis = (bool*)calloc(g->V, sizeof(bool));
-    bool* stack = (bool*)calloc(g->V, sizeof(bool));
+    LevelJob job = { adj, rev, vis, Create_BitSet(g->V), Create_BitSet(g->V),
+                     (int*)malloc(g->V * sizeof(int)), (int*)malloc(g->V * sizeof(int)),
+                     0, 0, 0, 0 };
+    uint64_t start = Start_Stats(), nodes = 0;
 
-    if (!vis || !stack) {
-        fprintf(stderr, "ERROR: VIS/STACK Memory allocation failed...");
-        free(vis);
-        free(stack);
+    if (!job.front || !job.next || !job.queue || !job.out) {
+        fprintf(stderr, "ERROR: Memory FRONTIER allocation failed...");
+        Free_BitSet(job.front);
+        Free_BitSet(job.next);
+        free(job.queue);
+        free(job.out);
         return false;
     }
 
-    bool hasCycle = false;
+    Clear_BitSet(vis);
+    Set_Bit(vis, src);
+    job.queue[0] = src;
+    job.size = 1;
+
+    long front = adj->offset[src + 1] - adj->offset[src];
+    long rest = adj->offset[g->V] - front;
+    bool bottomUp = false;
+
+    while (job.size > 0) {
+        if (!bottomUp && front > rest / BFS_ALPHA) {
+            // The frontier is heavy: switch to its bitmap.
+            Clear_BitSet(job.front);
+            for (int i = 0; i < job.size; i++)
+                Set_Bit(job.front, job.queue[i]);
+            bottomUp = true;
+        } else if (bottomUp && job.size < g->V / BFS_BETA) {
+            // The frontier is light again: back to its list.
+            int n = 0;
+            for (int u = Next_Bit(job.front, 0); u != -1; u = Next_Bit(job.front, u + 1))
+                job.queue[n++] = u;
+            bottomUp = false;
+        }
+
+        job.tail = 0;
+        job.edges = 0;
 
-    // Check for cycles starting from each unvisited node.
-    for (int node = 0; node < g->V && !hasCycle; node++) {
-        if (!vis[node]) {
-            hasCycle = TopoSort(g, node, vis, stack);
+        if (bottomUp) {
+            Run_Pool(pool, (vis->words + BFS_WORDS - 1) / BFS_WORDS, Bottom_Up, &job);
+            BitSet *swap = job.front;
+            job.front = job.next;
+            job.next = swap;
+        } else {
+            Run_Pool(pool, (job.size + BFS_GRAIN - 1) / BFS_GRAIN, Top_Down, &job);
+            int *swap = job.queue;
+            job.queue = job.out;
+            job.out = swap;
         }
+
+        job.size = job.tail;
+        nodes += job.size;
+        front = job.edges;
+        rest -= job.edges;
     }
 
-    free(vis);
-    free(stack);
-    return hasCycle;
+    // The source node is not part of its own path.
+    Clear_Bit(vis, src);
+    Stop_Stats(PHASE_SEARCH, start);
+    Add_Stats(COUNT_NODES, nodes + 1);
+    Add_Stats(COUNT_EDGES, job.scanned);
+
+    Free_BitSet(job.front);
+    Free_BitSet(job.next);
+    free(job.queue);
+    free(job.out);
+    return true;
+}
+
+/**
+ * @brief Topological sort of the graph using Kahn's algorithm.
+ * Every block comes after all of its parents (Genesis first). The walk is
+ * iterative, in O(V + E): the output array doubles as the FIFO queue.
+ * 
+ * @param g     A pointer to the graph.
+ * @param count Where to store the number of sorted nodes (less than V on a cycle).
+ * @return The array of sorted node indices (V entries allocated), or NULL on failure.
+ */
+int* TopoSort(Graph *g, int *count) {
+    *count = 0;
+    if (!g || !g->adjList.offset || !Refresh_TCSR(g)) return NULL;
+    uint64_t start = Start_Stats();
+
+    // Array for the pending parents of every node, and the resulting order.
+    int *inDeg = (int*)malloc((g->V ? g->V : 1) * sizeof(int));
+    int *order = (int*)malloc((g->V ? g->V : 1) * sizeof(int));
+
+    if (!inDeg || !order) {
+        fprintf(stderr, "ERROR: INDEG/ORDER Memory allocation failed...");
+        free(inDeg);
+        free(order);
+        return NULL;
+    }
+
+    int tail = 0;
+
+    // A node is ready once all of its parents (forward row) are placed.
+    for (int node = 0; node < g->V; node++) {
+        inDeg[node] = g->adjList.offset[node + 1] - g->adjList.offset[node];
+        if (!inDeg[node]) order[tail++] = node;
+    }
+
+    for (int head = 0; head < tail; head++) {
+        int node = order[head];
+        // Release the children of the node (transposed row).
+        for (int e = g->adjListT.offset[node]; e < g->adjListT.offset[node + 1]; e++) {
+            int child = g->adjListT.adj[e];
+            if (!--inDeg[child]) order[tail++] = child;
+        }
+    }
+
+    free(inDeg);
+    *count = tail;
+    Stop_Stats(PHASE_TOPO, start);
+    return order;
+}
+
+/**
+ * @brief Checks if the graph has a cycle using topological sorting.
+ * The nodes on (or behind) a cycle never reach in-degree zero.
+ * 
+ * @param g A pointer to the graph.
+ * @return true if the graph has a cycle, false otherwise.
+ */
+bool HasCycle(Graph *g) {
+    if (!g || !g->adjList.offset || !g->idxMap) return false;
+
+    int count = 0;
+    int *order = TopoSort(g, &count);
+    if (!order) return false;
+
+    free(order);
+    return count < g->V;
 }
@@ -1,127 +1,211 @@
 #include "../include/chain_list.h"
 
 /**
- * @brief Create a new node with a given name.
- * 
- * @param name The name to be stored in the new node.
- * @return A pointer to the newly created node, or NULL if allocation fails.
- */
-ListVal* Create_Ord(char *name) {
-    // Create a new node with a given name.
-    ListVal* node = (ListVal*)malloc(sizeof(ListVal));
-
-    if (node) {
-        // Copy the name into the node.
-        node->name = strdup(name);
-        // Memory allocation fails.
-        if (!node->name) {
-            fprintf(stderr, "Memory NODE allocation failed...");
-            free(node);
-            return NULL;
-        }
-        // Initialize the next pointer to NULL.
-        node->next = NULL;
-    }
-
-    // Return current created node.
-    return node;
-}
-
-/**
- * @brief Compare two strings and return their order.
+ * @brief Compare two names and return their order (Genesis first).
  * 
  * @param str1 The first string.
  * @param str2 The second string.
  * @return -1 if str1 is smaller, 1 if str2 is smaller, 0 if equal.
  */
-static int Compare(char *str1, char *str2) {
+int Compare_Ord(char *str1, char *str2) {
     if (!strcmp(str1, "Genesis")) return -1;
     if (!strcmp(str2, "Genesis")) return 1;
     return strcmp(str1, str2);
 }
 
 /**
- * @brief Insert a node into the linked list in an ordered manner.
+ * @brief qsort comparator of names (char*) in list order.
+ */
+static int Compare_Names(const void *a, const void *b) {
+    return Compare_Ord(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief qsort comparator of slots of the index map (char**) in list order.
+ */
+static int Compare_Slots(const void *a, const void *b) {
+    return Compare_Ord(**(char **const *)a, **(char **const *)b);
+}
+
+/**
+ * @brief qsort comparator of ranks.
+ */
+static int Compare_Ranks(const void *a, const void *b) {
+    int r1 = *(const int*)a, r2 = *(const int*)b;
+    return (r1 > r2) - (r1 < r2);
+}
+
+/**
+ * @brief Rank every name of the graph in list order (Genesis first), so that
+ * sets are ordered by comparing integers. The names are sorted once, by
+ * sorting pointers into the index map, and measured once, so that printing
+ * copies them without strlen. Appending a block leaves the ranks stale
+ * (ranked != V) until the next call, which only sorts the appended names
+ * and merges them with the ranked ones in O(V).
  * 
- * @param list The linked list.
- * @param name The name to be inserted.
- * @return A pointer to the updated linked list.
+ * @param g The graph.
+ * @return true if the ranks are up to date, false on failure.
  */
-ListVal* Insert_Ord(ListVal *list, char *name) {
-    // Create a new node with the given name.
-    ListVal* node = Create_Ord(name);
-    if (!node) return list;
-
-    // Initialize a pointer to traverse the list.
-    ListVal* pass = list;
-    // Initialize a pointer to keep track the previous node.
-    ListVal* prev = NULL;
-
-    // Traverse the list until the correct position is found.
-    while (pass && Compare(pass->name, name) < 0) {
-        prev = pass;
-        pass = pass->next;
+bool Rank_Names(Graph *g) {
+    if (!g || !g->idxMap) return false;
+    if (g->rank && g->ranked == g->V) return true;
+
+    uint64_t start = Start_Stats();
+    int V = g->V, old = g->rank && g->byRank ? g->ranked : 0, fresh = V - old;
+    char ***slots = (char***)malloc((fresh ? fresh : 1) * sizeof(char**));
+    int *merged = (int*)malloc((V ? V : 1) * sizeof(int));
+    int *rank = (int*)realloc(g->rank, (V ? V : 1) * sizeof(int));
+    if (rank) g->rank = rank;
+    int *nameLen = (int*)realloc(g->nameLen, (V ? V : 1) * sizeof(int));
+    if (nameLen) g->nameLen = nameLen;
+
+    if (!slots || !merged || !rank || !nameLen) {
+        fprintf(stderr, "Memory RANK allocation failed...");
+        free(slots);
+        free(merged);
+        g->ranked = 0;
+        return false;
     }
 
-    // Insert the new node.
-    if (pass == list) {
-        // At the begging.
-        node->next = list;
-        list = node;
-    } else if (!pass) {
-        // At the end.
-        prev->next = node;
-    } else {
-        // In the middle.
-        node->next = pass;
-        prev->next = node;
+    for (int u = old; u < V; u++) {
+        slots[u - old] = &g->idxMap[u];
+        nameLen[u] = (int)strlen(g->idxMap[u]);
     }
+    qsort(slots, fresh, sizeof(char**), Compare_Slots);
 
-    // Return the updated list.
-    return list;
+    // Merge the ranked vertices with the sorted new ones (no name is equal).
+    int i = 0, j = 0, r = 0;
+    while (i < old || j < fresh) {
+        if (j == fresh || (i < old && Compare_Ord(g->idxMap[g->byRank[i]], *slots[j]) < 0))
+            merged[r++] = g->byRank[i++];
+        else
+            merged[r++] = (int)(slots[j++] - g->idxMap);
+    }
+
+    for (r = 0; r < V; r++)
+        rank[merged[r]] = r;
+
+    free(slots);
+    free(g->byRank);
+    g->byRank = merged;
+    g->ranked = V;
+    Stop_Stats(PHASE_SETS, start);
+    return true;
 }
 
 /**
- * @brief Print the elements of the list in order to a file.
+ * @brief Compare two vertices in list order (Genesis first, then by name),
+ * in O(1) when the ranks of the graph are up to date.
  * 
- * @param list The linked list to be printed.
- * @param fout The file to which the elements will be printed.
+ * @param g The graph.
+ * @param u The first vertex.
+ * @param v The second vertex.
+ * @return A negative value if u comes first, positive if v does, 0 if equal.
  */
-void Print_Ord(ListVal *list, FILE *fout) {
-    while (list) {
-        fprintf(fout, "%s ", list->name);
-        list = list->next;
-    }
-    fprintf(fout, "\n");
+int Order_Nodes(Graph *g, int u, int v) {
+    if (u == v) return 0;
+    if (g->rank && g->ranked == g->V)
+        return g->rank[u] < g->rank[v] ? -1 : 1;
+    return Compare_Ord(Get_ValNode(g, u), Get_ValNode(g, v));
 }
 
 /**
- * @brief Check if a given name exists in the list.
+ * @brief Print the names of a vertex set to a writer, in list order.
+ * The set is only converted to names here, at print time, with the scratch
+ * arena of the graph.
  * 
- * @param list The linked list to be checked.
- * @param name The name to search for.
- * @return true if the name is found in the list, false otherwise.
+ * @param g   The graph owning the names.
+ * @param set The vertex set to be printed.
+ * @param out The writer to which the names will be printed.
  */
-bool Contains_Ord(ListVal *list, char *name) {
-    while (list) {
-        if (!strcmp(list->name, name))
-            return true; // Name is found, return true.
-        list = list->next;
-    }
-    return false; // Name is not found.
+void Print_Set(Graph *g, BitSet *set, Writer *out) {
+    Write_Set(g, g->scratch, set, out);
+}
+
+/**
+ * @brief Copy a ranked vertex name and its separator into a writer.
+ * 
+ * @param g   The graph, with up to date ranks.
+ * @param v   The vertex.
+ * @param out The writer.
+ */
+static inline void Put_Name(Graph *g, int v, Writer *out) {
+    Put_Bytes(out, g->idxMap[v], g->nameLen[v]);
+    Put_Char(out, ' ');
 }
 
 /**
- * @brief Free the memory allocated for the linked list.
+ * @brief Mark the writer of a set as failed, the set could not be ordered:
+ * an empty line would read as an empty set.
  * 
- * @param list The linked list to be freed.
+ * @param out The writer.
  */
-void Free_Ord(ListVal* list) {
-    while (list) {
-        ListVal* elem = list;
-        list = list->next;
-        // Free the memory for the name and node.
-        free(elem->name);
-        free(elem);
+static void Fail_Set(Writer *out) {
+    fprintf(stderr, "Memory SET allocation failed...");
+    out->failed = true;
+}
+
+/**
+ * @brief Print the names of a vertex set to a writer, in list order, with the
+ * scratch drawn from a given arena (reset afterwards), so that threads
+ * sharing the graph each use their own. With up to date ranks, a dense set
+ * is printed by walking all the ranks (O(V)) and a sparse one by sorting the
+ * ranks of its members (O(k log k) integer compares), the names being copied
+ * with their measured lengths. Without ranks, the names of the members are
+ * sorted (O(k log k) string compares). If the set is missing (it could not
+ * be computed) or the scratch cannot be allocated, the writer is marked
+ * failed, so the run does not end with a wrong set.
+ * 
+ * @param g     The graph owning the names.
+ * @param arena The arena holding the scratch.
+ * @param set   The vertex set to be printed.
+ * @param out   The writer to which the names will be printed.
+ */
+void Write_Set(Graph *g, Arena *arena, BitSet *set, Writer *out) {
+    if (!set) {
+        Fail_Set(out);
+        return;
     }
+
+    uint64_t start = Start_Stats(), print = 0;
+    int count = Count_BitSet(set), k = 0;
+    bool ranked = g->rank && g->ranked == g->V;
+
+    if (count && ranked && (long)count * RANK_DENSE >= g->V) {
+        print = Start_Stats();
+        Stop_Stats(PHASE_SETS, start);
+        for (int r = 0; r < g->V; r++) {
+            if (Test_Bit(set, g->byRank[r])) Put_Name(g, g->byRank[r], out);
+        }
+    } else if (count && ranked) {
+        int *ranks = (int*)Alloc_Arena(arena, count * sizeof(int));
+        if (!ranks) Fail_Set(out);
+        for (int v = Next_Bit(set, 0); ranks && v != -1; v = Next_Bit(set, v + 1))
+            ranks[k++] = g->rank[v];
+        if (ranks) qsort(ranks, k, sizeof(int), Compare_Ranks);
+
+        print = Start_Stats();
+        Stop_Stats(PHASE_SETS, start);
+        for (int i = 0; i < k; i++) Put_Name(g, g->byRank[ranks[i]], out);
+    } else if (count) {
+        char **names = (char**)Alloc_Arena(arena, count * sizeof(char*));
+        if (!names) Fail_Set(out);
+        for (int v = Next_Bit(set, 0); names && v != -1; v = Next_Bit(set, v + 1))
+            names[k++] = Get_ValNode(g, v);
+        if (names) qsort(names, k, sizeof(char*), Compare_Names);
+
+        print = Start_Stats();
+        Stop_Stats(PHASE_SETS, start);
+        for (int i = 0; i < k; i++) {
+            Put_Str(out, names[i]);
+            Put_Char(out, ' ');
+        }
+    } else {
+        print = Start_Stats();
+        Stop_Stats(PHASE_SETS, start);
+    }
+
+    Put_Char(out, '\n');
+    Stop_Stats(PHASE_OUTPUT, print);
+    Reset_Arena(arena);
 }
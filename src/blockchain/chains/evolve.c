@@ -5,10 +5,11 @@
  * 
  * @param g   The graph.
  * @param src The index of the vertex.
- * @return The past set of nodes as a linked list.
+ * @return The past set of nodes as a bitset.
  */
-ListVal* Past(Graph *g, int src) {
-    return Path_Vis(g, src);
+BitSet* Past(Graph *g, int src) {
+    if (!g) return NULL;
+    return Path_Vis(g, &g->adjList, src);
 }
 
 /**
@@ -16,85 +17,409 @@ ListVal* Past(Graph *g, int src) {
  * 
  * @param g   The graph.
  * @param src The index of the vertex.
- * @return The future set of nodes as a linked list.
+ * @return The future set of nodes as a bitset.
  */
-ListVal* Future(Graph *g, int src) {
-    if (!g || !g->adjList || !g->idxMap) return NULL;
-    // The future can be seen by going in reverse.
-    Graph *graphT = Create_TGraph(g);
-    // Find the path in the transpose graph.
-    ListVal *path = Path_Vis(graphT, src);
+BitSet* Future(Graph *g, int src) {
+    if (!g || !Refresh_TCSR(g)) return NULL;
+    // The future can be seen by going in reverse, along the transposed adjacency.
+    return Path_Vis(g, &g->adjListT, src);
+}
 
-    Free_Graph(graphT);
-    return path;
+/**
+ * @brief Computes the past set of a given vertex into caller owned buffers.
+ * 
+ * @param g     The graph.
+ * @param src   The index of the vertex.
+ * @param past  The past set, over [0, V).
+ * @param queue The frontier of the search.
+ * @return true on success, false on failure.
+ */
+bool Past_Into(Graph *g, int src, BitSet *past, Queue *queue) {
+    if (!g) return false;
+    return Path_Into(g, &g->adjList, src, past, queue);
+}
+
+/**
+ * @brief Computes the future set of a given vertex into caller owned buffers.
+ * The transposed adjacency is not refreshed here: when called from several
+ * threads, Refresh_TCSR must have been called before.
+ * 
+ * @param g      The graph.
+ * @param src    The index of the vertex.
+ * @param future The future set, over [0, V).
+ * @param queue  The frontier of the search.
+ * @return true on success, false on failure.
+ */
+bool Future_Into(Graph *g, int src, BitSet *future, Queue *queue) {
+    if (!g || g->staleT) return false;
+    return Path_Into(g, &g->adjListT, src, future, queue);
+}
+
+/**
+ * @brief Computes the past set of a single vertex level by level on a pool,
+ * going bottom-up (children rows) while the frontier is wide.
+ * 
+ * @param g    The graph, its transposed adjacency up to date.
+ * @param pool The workers (NULL for the calling thread only).
+ * @param src  The index of the vertex.
+ * @param past The past set, over [0, V).
+ * @return true on success, false on failure.
+ */
+bool Past_Levels(Graph *g, Pool *pool, int src, BitSet *past) {
+    if (!g || g->staleT) return false;
+    return Path_Levels(g, &g->adjList, &g->adjListT, src, past, pool);
+}
+
+/**
+ * @brief Computes the future set of a single vertex level by level on a pool,
+ * going bottom-up (parent rows) while the frontier is wide.
+ * 
+ * @param g      The graph, its transposed adjacency up to date.
+ * @param pool   The workers (NULL for the calling thread only).
+ * @param src    The index of the vertex.
+ * @param future The future set, over [0, V).
+ * @return true on success, false on failure.
+ */
+bool Future_Levels(Graph *g, Pool *pool, int src, BitSet *future) {
+    if (!g || g->staleT) return false;
+    return Path_Levels(g, &g->adjListT, &g->adjList, src, future, pool);
+}
+
+/**
+ * @brief Checks if a node is in the past of a given vertex, in O(1) on average.
+ * 
+ * @param ri   The reachability index of the graph.
+ * @param src  The index of the vertex.
+ * @param node The index of the node to look for.
+ * @return true if node belongs to past(src), false otherwise.
+ */
+bool InPast(ReachIndex *ri, int src, int node) {
+    return src != node && Reaches(ri, src, node);
+}
+
+/**
+ * @brief Checks if a node is in the future of a given vertex, in O(1) on average.
+ * 
+ * @param ri   The reachability index of the graph.
+ * @param src  The index of the vertex.
+ * @param node The index of the node to look for.
+ * @return true if node belongs to future(src), false otherwise.
+ */
+bool InFuture(ReachIndex *ri, int src, int node) {
+    return src != node && Reaches(ri, node, src);
 }
 
 /**
  * @brief Returns the anticone set of nodes for a given vertex.
- * The anticone set contains nodes that are neither in the past nor in the future.
+ * The anticone set contains nodes that are neither in the past nor in the future,
+ * computed word-wise as ~(past | future | src).
  * 
  * @param g      The graph.
  * @param src    The index of the vertex.
  * @param past   The past set of nodes.
  * @param future The future set of nodes.
- * @return The anticone set of nodes as a linked list.
+ * @return The anticone set of nodes as a bitset.
  */
-ListVal* Anticone(Graph *g, int src, ListVal *past, ListVal *future) {
-    if (!g || !g->adjList || !g->idxMap) return NULL;
+BitSet* Anticone(Graph *g, int src, BitSet *past, BitSet *future) {
+    if (!g || !past || !future) return NULL;
 
-    ListVal *path = NULL;
+    uint64_t start = Start_Stats();
+    BitSet *path = Copy_BitSet(past);
+    if (!path) return NULL;
 
-    // Iterate through all nodes in the graph.
-    for (int pass = 0; pass < g->V; pass++) {
-        char *name = Get_ValNode(g, pass);
-        if (src != pass) {
-            // If the node is not in the past and not in the future, add it to the anticone.
-            if (!Contains_Ord(past, name) && !Contains_Ord(future, name)) {
-                path = Insert_Ord(path, name);
-            }
-        }
-    }
+    Union_BitSet(path, future);
+    Set_Bit(path, src);
+    Complement_BitSet(path);
 
+    Stop_Stats(PHASE_SETS, start);
     return path;
 }
 
+/**
+ * @brief Computes the anticone set of a given vertex into a caller owned set.
+ * 
+ * @param src      The index of the vertex.
+ * @param past     The past set of nodes.
+ * @param future   The future set of nodes.
+ * @param anticone The anticone set, over [0, V).
+ */
+void Anticone_Into(int src, BitSet *past, BitSet *future, BitSet *anticone) {
+    uint64_t start = Start_Stats();
+    Clear_BitSet(anticone);
+    Union_BitSet(anticone, past);
+    Union_BitSet(anticone, future);
+    Set_Bit(anticone, src);
+    Complement_BitSet(anticone);
+    Stop_Stats(PHASE_SETS, start);
+}
+
 /**
  * @brief Returns the tips set of nodes in the graph.
- * The tips set contains nodes with no incoming edges.
+ * The tips set contains nodes with no incoming edges, it is kept up to date
+ * by the graph itself as blocks are appended.
  * 
  * @param g The graph.
- * @return The tips set of nodes as a linked list.
+ * @return The tips set of nodes as a bitset.
  */
-ListVal* Tips(Graph *g) {
-    if (!g || !g->adjList || !g->idxMap) return NULL;
+BitSet* Tips(Graph *g) {
+    if (!g || !g->tips) return NULL;
+    return Copy_BitSet(g->tips);
+}
+
+/* ----------------------------------------------------------------------------------- */
 
-    // Allocate memory for an array to store in-degrees of nodes.
-    int *inDeg = (int*)calloc(g->V, sizeof(int));
+/**
+ * @brief Add a word to 64 bit-sliced counters: counter j is spread over the
+ * planes, bit j of plane i being its bit i. Ripple carry, stopping as soon
+ * as no carry is left (amortized O(1) planes per add).
+ * 
+ * @param planes The counter planes, CONE_LANES words apart.
+ * @param depth  The number of planes.
+ * @param w      The word, bit j adds one to counter j.
+ */
+static inline void Add_Sliced(uint64_t *planes, int depth, uint64_t w) {
+    for (int i = 0; i < depth && w; i++) {
+        uint64_t carry = planes[i * CONE_LANES] & w;
+        planes[i * CONE_LANES] ^= w;
+        w = carry;
+    }
+}
 
-    if (!inDeg) {
-        fprintf(stderr, "Memory INDEG allocation failed...");
-        return NULL;
+/**
+ * @brief Read the bit-sliced counters of one lane back into integers.
+ * 
+ * @param planes The counter planes, CONE_LANES words apart.
+ * @param depth  The number of planes.
+ * @param extra  A count added to every counter.
+ * @param out    Where to store the counters.
+ * @param n      The number of counters to read.
+ */
+static void Read_Sliced(const uint64_t *planes, int depth, int extra, int *out, int n) {
+    for (int j = 0; j < n; j++) {
+        int val = 0;
+        for (int i = 0; i < depth; i++)
+            val |= (int)((planes[i * CONE_LANES] >> j) & 1) << i;
+        out[j] = val + extra;
     }
+}
+
+/**
+ * @brief Sweep one batch of up to CONE_BATCH sources along an order of the
+ * graph, where every vertex comes after its neighbors in adj. The words of a
+ * vertex (CONE_LANES of them) hold the sources it is reachable from (OR of
+ * its neighbors), and are counted before its own source bit is added. The
+ * sweep starts at the first source in the walk, every vertex before it has
+ * empty words. Far from the batch most words hold every source: those are
+ * counted once in a scalar instead of rippling through the planes.
+ * 
+ * @param adj    The adjacency whose neighbors come first in the walk.
+ * @param order  The order of the vertices.
+ * @param from   The position in the order where the walk starts.
+ * @param to     The position in the order where the walk stops (excluded).
+ * @param step   1 to walk the order forward, -1 backward.
+ * @param base   The first source of the batch.
+ * @param n      The number of sources in the batch.
+ * @param depth  The number of counter planes.
+ * @param reach  Scratch words, CONE_LANES per vertex, all zero (left zero).
+ * @param sizes  Where to store the set size of every source.
+ */
+static void Sweep_Batch(AdjCSR *adj, const int *order, int from, int to, int step,
+                        int base, int n, int depth, uint64_t *reach, int *sizes) {
+    uint64_t planes[32 * CONE_LANES] = { 0 };
+    uint64_t mask[CONE_LANES] = { 0 };
+    int full = 0;
+
+    // The bits of the sources of the batch, lane by lane.
+    for (int j = 0; j < n; j++)
+        mask[j / 64] |= 1ull << (j % 64);
 
-    // Calculate in-degrees for all nodes in the graph.
-    for (int pass = 0; pass < g->V; pass++) {
-        GraphNode *node = g->adjList[pass];
-        while (node) {
-            int idx = Get_IdxNode(g, node->name);
-            inDeg[idx]++;
-            node = node->next;
+    for (int i = from; i != to; i += step) {
+        int v = order[i];
+        uint64_t w[CONE_LANES] = { 0 };
+
+        for (int e = adj->offset[v]; e < adj->offset[v + 1]; e++) {
+            const uint64_t *r = &reach[(size_t)adj->adj[e] * CONE_LANES];
+            for (int l = 0; l < CONE_LANES; l++)
+                w[l] |= r[l];
+        }
+
+        if (!memcmp(w, mask, sizeof(w))) {
+            full++;
+        } else {
+            for (int l = 0; l < CONE_LANES; l++)
+                Add_Sliced(&planes[l], depth, w[l]);
         }
+        if (v >= base && v < base + n)
+            w[(v - base) / 64] |= 1ull << ((v - base) % 64);
+        memcpy(&reach[(size_t)v * CONE_LANES], w, sizeof(w));
     }
 
-    ListVal *path = NULL;
+    // Clear what the sweep wrote, for the next one.
+    for (int i = from; i != to; i += step)
+        memset(&reach[(size_t)order[i] * CONE_LANES], 0, CONE_LANES * sizeof(uint64_t));
+
+    for (int l = 0; l * 64 < n; l++) {
+        int cnt = n - l * 64 < 64 ? n - l * 64 : 64;
+        Read_Sliced(&planes[l], depth, full, &sizes[base + l * 64], cnt);
+    }
+}
 
-    // Find nodes with zero in-degrees and add them to the tips set.
-    for (int pass = 0; pass < g->V; pass++) {
-        if (!inDeg[pass]) {
-            path = Insert_Ord(path, Get_ValNode(g, pass));
+// Shared state of the batches of Cone_Sizes, one batch per pool item.
+typedef struct ConeJob {
+    Graph *g;               // The graph.
+    const int *order;       // Topological order.
+    const int *pos;         // Position of every block in the order.
+    int depth;              // Planes of the bit-sliced counters.
+    size_t words;           // Scratch words of one worker.
+    uint64_t *reach;        // Scratch words of all the workers.
+    int *past;              // Past sizes (output).
+    int *future;            // Future sizes (output).
+} ConeJob;
+
+/**
+ * @brief Run the two sweeps of one batch, with the scratch of the worker.
+ * 
+ * @param ctx    The job (ConeJob).
+ * @param worker The worker running the batch.
+ * @param item   The index of the batch.
+ */
+static void Cone_Batch(void *ctx, int worker, int item) {
+    ConeJob *job = (ConeJob*)ctx;
+    int V = job->g->V;
+    int base = item * CONE_BATCH;
+    int n = V - base < CONE_BATCH ? V - base : CONE_BATCH;
+    uint64_t *reach = &job->reach[(size_t)worker * job->words];
+
+    int lo = V, hi = -1;
+    for (int v = base; v < base + n; v++) {
+        if (job->pos[v] < lo) lo = job->pos[v];
+        if (job->pos[v] > hi) hi = job->pos[v];
+    }
+
+    // A block is in the future of a source if one of its parents is.
+    Sweep_Batch(&job->g->adjList, job->order, lo, V, 1, base, n, job->depth, reach, job->future);
+    // A block is in the past of a source if one of its children is.
+    Sweep_Batch(&job->g->adjListT, job->order, hi, -1, -1, base, n, job->depth, reach, job->past);
+}
+
+/**
+ * @brief Compute the sizes of past, future and anticone of every block.
+ * Instead of one search per block, the blocks are taken CONE_BATCH at a time
+ * as the bits of CONE_LANES words, and each batch is two sweeps over a
+ * topological order: parents first for the futures, children first for the
+ * pasts. That is V / CONE_BATCH passes of O(V + E) word operations in total,
+ * each sweep starting at the first source of the batch it can reach. The
+ * batches are independent and spread over the pool, each worker sweeping
+ * with its own scratch words. The blocks pruned from the graph still count.
+ * 
+ * @param g        The graph.
+ * @param pool     The pool running the batches (NULL for the calling thread).
+ * @param past     Where to store |past(v)| of every block (V entries).
+ * @param future   Where to store |future(v)| of every block (V entries).
+ * @param anticone Where to store |anticone(v)| of every block (V entries).
+ * @return true on success, false if the graph has a cycle or on failure.
+ */
+bool Cone_Sizes(Graph *g, Pool *pool, int *past, int *future, int *anticone) {
+    if (!g || !past || !future || !anticone) return false;
+
+    // TopoSort also brings the transposed adjacency up to date.
+    int count = 0;
+    int *order = TopoSort(g, &count);
+    if (!order) return false;
+
+    int V = g->V;
+    int workers = pool ? pool->size : 1;
+    size_t words = (size_t)(V ? V : 1) * CONE_LANES;
+    uint64_t *reach = (uint64_t*)calloc(words * workers, sizeof(uint64_t));
+    int *pos = (int*)malloc((V ? V : 1) * sizeof(int));
+
+    if (count < V || !reach || !pos) {
+        free(order);
+        free(reach);
+        free(pos);
+        return false;
+    }
+
+    // Position of every block in the order, and bits needed per counter.
+    for (int i = 0; i < V; i++)
+        pos[order[i]] = i;
+    int depth = 1;
+    while (depth < 31 && (1 << depth) <= V) depth++;
+
+    uint64_t start = Start_Stats();
+    ConeJob job = { g, order, pos, depth, words, reach, past, future };
+    Run_Pool(pool, (V + CONE_BATCH - 1) / CONE_BATCH, Cone_Batch, &job);
+    Stop_Stats(PHASE_CONES, start);
+
+    // Pruned blocks are all in the past, none of them is counted by the sweeps.
+    if (g->prunedPast) {
+        for (int v = 0; v < V; v++)
+            past[v] += g->prunedPast[v];
+    }
+    for (int v = 0; v < V; v++)
+        anticone[v] = V + g->pruned - 1 - past[v] - future[v];
+
+    free(order);
+    free(reach);
+    free(pos);
+    return true;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+/**
+ * @brief Prune the finalized history behind a block: its whole past is
+ * dropped and the graph compacted, the block becoming the new genesis.
+ * Every kept block remembers how many pruned blocks were in its past, so
+ * the cone sizes stay those of the full history: all of them for the block
+ * and its future, and the ones seen by one more search for every block of
+ * its anticone (few, once the block is deep enough to be final).
+ * 
+ * @param g     The graph, a DAG.
+ * @param point The index of the pruning point.
+ * @return The number of pruned blocks, or -1 on failure.
+ */
+int Prune_Past(Graph *g, int point) {
+    if (!g || point < 0 || point >= g->V || !Refresh_TCSR(g)) return -1;
+
+    int V = g->V;
+    BitSet *past = Past(g, point);
+    BitSet *future = Future(g, point);
+    BitSet *cone = Create_BitSet(V);
+    Queue *queue = Create_Queue(V);
+    int *gain = (int*)malloc((V ? V : 1) * sizeof(int));
+
+    if (!g->prunedPast)
+        g->prunedPast = (int*)calloc(g->capV ? g->capV : 1, sizeof(int));
+
+    bool ok = past && future && cone && queue && gain && g->prunedPast;
+    int size = ok ? Count_BitSet(past) : -1;
+
+    // Pruned blocks newly in the past of every kept block.
+    for (int v = 0; ok && v < V; v++) {
+        if (Test_Bit(past, v)) continue;
+        if (v == point || Test_Bit(future, v)) {
+            gain[v] = size;
+            continue;
         }
+        ok = Past_Into(g, v, cone, queue);
+        gain[v] = Count_BitSet(cone);
+        AndNot_BitSet(cone, past);
+        gain[v] -= Count_BitSet(cone);
     }
 
-    free(inDeg);
-    return path;
-}
\ No newline at end of file
+    ok = ok && Compact_Graph(g, past);
+
+    // The kept blocks keep their order, renumbered from 0.
+    for (int v = 0, k = 0; ok && v < V; v++) {
+        if (!Test_Bit(past, v)) g->prunedPast[k++] += gain[v];
+    }
+    if (ok) g->pruned += size;
+
+    Free_BitSet(past);
+    Free_BitSet(future);
+    Free_BitSet(cone);
+    Free_Queue(queue);
+    free(gain);
+    return ok ? size : -1;
+}
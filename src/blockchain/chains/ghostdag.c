@@ -0,0 +1,577 @@
+#include "../include/ghostdag.h"
+#include "../include/chain_graph.h"
+#include "../include/chain_list.h"
+
+// Working state of a GHOSTDAG run.
+typedef struct Builder {
+    GhostDag *gd;           // The data being filled.
+    Graph *g;               // The graph.
+    ReachIndex *ri;         // Reachability of the graph.
+    int bluesCap;           // Allocated entries of gd->blues.
+    int bluesCnt;           // Used entries of gd->blues.
+    int sizesCap;           // Allocated entries of gd->sizeBlock / gd->sizeVal.
+    int sizesCnt;           // Used entries of gd->sizeBlock / gd->sizeVal.
+    int *mark;              // Visit stamps of the merge set walk.
+    int epoch;              // Stamp of the current walk.
+    Queue *queue;           // Frontier of the merge set walk.
+    int *merge;             // Merge set of the current block (without the selected parent).
+    int mergeLen;           // Size of the merge set.
+    int *anti;              // Blues in the anticone of the current candidate.
+    int *antiSize;          // Their anticone sizes within the current blues.
+    int antiLen;            // Number of such blues.
+} Builder;
+
+// Context of the merge set comparator (qsort has no user argument in C99).
+static Builder *sortCtx = NULL;
+
+/**
+ * @brief Order merge set blocks by blue score, then by name (Genesis first).
+ * A block always scores higher than its ancestors, so this order is topological.
+ */
+static int Compare_Merge(const void *a, const void *b) {
+    int u = *(const int*)a, v = *(const int*)b;
+    int *score = sortCtx->gd->blueScore;
+
+    if (score[u] != score[v]) return score[u] < score[v] ? -1 : 1;
+    return Order_Nodes(sortCtx->g, u, v);
+}
+
+/**
+ * @brief Append a block to the merge set blues of the block being built.
+ * 
+ * @param bd    The working state.
+ * @param owner The block being built.
+ * @param blue  The blue block.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Push_Blue(Builder *bd, int owner, int blue) {
+    GhostDag *gd = bd->gd;
+
+    if (bd->bluesCnt == bd->bluesCap) {
+        int *blues = (int*)realloc(gd->blues, 2 * bd->bluesCap * sizeof(int));
+        if (!blues) return false;
+        gd->blues = blues;
+        bd->bluesCap *= 2;
+    }
+
+    gd->blues[bd->bluesCnt++] = blue;
+    gd->bluesLen[owner]++;
+    return true;
+}
+
+/**
+ * @brief Record the anticone size of a blue block within the blues of the
+ * block being built (its entries are the tail of the size arrays).
+ * 
+ * @param bd    The working state.
+ * @param owner The block being built.
+ * @param blue  The blue block.
+ * @param size  Its anticone size.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Put_Size(Builder *bd, int owner, int blue, int size) {
+    GhostDag *gd = bd->gd;
+
+    // Update the entry if the block already has one.
+    for (int s = gd->sizesStart[owner]; s < bd->sizesCnt; s++) {
+        if (gd->sizeBlock[s] == blue) {
+            gd->sizeVal[s] = size;
+            return true;
+        }
+    }
+
+    if (bd->sizesCnt == bd->sizesCap) {
+        int *block = (int*)realloc(gd->sizeBlock, 2 * bd->sizesCap * sizeof(int));
+        if (!block) return false;
+        gd->sizeBlock = block;
+        int *val = (int*)realloc(gd->sizeVal, 2 * bd->sizesCap * sizeof(int));
+        if (!val) return false;
+        gd->sizeVal = val;
+        bd->sizesCap *= 2;
+    }
+
+    gd->sizeBlock[bd->sizesCnt] = blue;
+    gd->sizeVal[bd->sizesCnt] = size;
+    bd->sizesCnt++;
+    gd->sizesLen[owner]++;
+    return true;
+}
+
+/**
+ * @brief Anticone size of a blue block within the blues of a context block:
+ * the most recent record along the selected parent chain of the context.
+ * 
+ * @param gd      The GHOSTDAG data.
+ * @param context The block whose blues are considered.
+ * @param blue    The blue block.
+ * @return The anticone size of the blue block.
+ */
+static int Blue_Anticone_Size(GhostDag *gd, int context, int blue) {
+    for (int x = context; x != -1; x = gd->selParent[x]) {
+        int end = gd->sizesStart[x] + gd->sizesLen[x];
+        for (int s = gd->sizesStart[x]; s < end; s++) {
+            if (gd->sizeBlock[s] == blue)
+                return gd->sizeVal[s];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Collect the merge set of a block, past(block) minus past(sp) and sp,
+ * walking back from the other parents and stopping at the past of sp.
+ * Every block is enqueued at most once, into a queue sized for all of them.
+ * 
+ * @param bd      The working state.
+ * @param parents The parents of the block.
+ * @param count   The number of parents.
+ * @param sp      The selected parent.
+ */
+static void Merge_Set(Builder *bd, const int *parents, int count, int sp) {
+    AdjCSR *adj = &bd->g->adjList;
+    bd->mergeLen = 0;
+
+    // New stamp for this walk, restart the stamps before they overflow.
+    if (++bd->epoch == INT32_MAX) {
+        memset(bd->mark, 0, bd->gd->cap * sizeof(int));
+        bd->epoch = 1;
+    }
+
+    for (int p = 0; p < count; p++) {
+        int u = parents[p];
+        if (bd->mark[u] == bd->epoch || u == sp) continue;
+        bd->mark[u] = bd->epoch;
+        if (!Reaches(bd->ri, sp, u)) Enqueue(bd->queue, u);
+    }
+
+    while (!IsEmpty_Queue(bd->queue)) {
+        int u = Front(bd->queue);
+        Dequeue(bd->queue);
+        bd->merge[bd->mergeLen++] = u;
+
+        for (int e = adj->offset[u]; e < adj->offset[u + 1]; e++) {
+            int v = adj->adj[e];
+            if (bd->mark[v] == bd->epoch || v == sp) continue;
+            bd->mark[v] = bd->epoch;
+            if (!Reaches(bd->ri, sp, v)) Enqueue(bd->queue, v);
+        }
+    }
+}
+
+/**
+ * @brief Check a merge set candidate against the blues of the block being
+ * built. Walks the selected parent chain of the block until a chain block in
+ * past(candidate), collecting the blues in its anticone.
+ * 
+ * @param bd    The working state.
+ * @param owner The block being built.
+ * @param cand  The candidate block.
+ * @param count Where to store the anticone size of the candidate.
+ * @return true if the candidate can be colored blue, false otherwise.
+ */
+static bool Check_Blue(Builder *bd, int owner, int cand, int *count) {
+    GhostDag *gd = bd->gd;
+    bd->antiLen = 0;
+    *count = 0;
+
+    for (int x = owner; x != -1; x = gd->selParent[x]) {
+        // Everything below a chain block in past(cand) is in past(cand) too.
+        if (x != owner && Reaches(bd->ri, cand, x)) break;
+
+        int end = gd->bluesStart[x] + gd->bluesLen[x];
+        for (int j = gd->bluesStart[x]; j < end; j++) {
+            int blue = gd->blues[j];
+            if (Reaches(bd->ri, cand, blue)) continue;
+
+            // The blue is in the anticone of the candidate.
+            if (++(*count) > gd->k) return false;
+            int size = Blue_Anticone_Size(gd, owner, blue);
+            if (size == gd->k) return false;
+
+            bd->anti[bd->antiLen] = blue;
+            bd->antiSize[bd->antiLen] = size;
+            bd->antiLen++;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Compute the GHOSTDAG data of one block, its parents already done.
+ * 
+ * @param bd      The working state.
+ * @param owner   The block (V for the virtual block).
+ * @param parents The parents of the block.
+ * @param count   The number of parents.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Color_Block(Builder *bd, int owner, const int *parents, int count) {
+    GhostDag *gd = bd->gd;
+    gd->bluesStart[owner] = bd->bluesCnt;
+    gd->bluesLen[owner] = 0;
+    gd->sizesStart[owner] = bd->sizesCnt;
+    gd->sizesLen[owner] = 0;
+
+    // Roots have no blues of their own.
+    if (!count) {
+        gd->selParent[owner] = -1;
+        gd->blueScore[owner] = 0;
+        return true;
+    }
+
+    // Selected parent: highest blue score, ties to the first name.
+    int sp = parents[0];
+    for (int p = 1; p < count; p++) {
+        int u = parents[p];
+        if (gd->blueScore[u] > gd->blueScore[sp]
+            || (gd->blueScore[u] == gd->blueScore[sp]
+                && Order_Nodes(bd->g, u, sp) < 0))
+            sp = u;
+    }
+    gd->selParent[owner] = sp;
+
+    if (!Push_Blue(bd, owner, sp) || !Put_Size(bd, owner, sp, 0))
+        return false;
+
+    // Candidates in topological order, each checked against the blues so far.
+    Merge_Set(bd, parents, count, sp);
+    sortCtx = bd;
+    qsort(bd->merge, bd->mergeLen, sizeof(int), Compare_Merge);
+
+    for (int m = 0; m < bd->mergeLen; m++) {
+        int cand = bd->merge[m], size = 0;
+        if (!Check_Blue(bd, owner, cand, &size)) continue;
+
+        if (!Push_Blue(bd, owner, cand) || !Put_Size(bd, owner, cand, size))
+            return false;
+        for (int a = 0; a < bd->antiLen; a++) {
+            if (!Put_Size(bd, owner, bd->anti[a], bd->antiSize[a] + 1))
+                return false;
+        }
+    }
+
+    gd->blueScore[owner] = gd->blueScore[sp] + gd->bluesLen[owner];
+    return true;
+}
+
+/**
+ * @brief Make room for the blocks of the graph (and the virtual block) in
+ * the per-block arrays and the walk scratch, doubling their slots. The walk
+ * queue holds every block and the anticone scratch min(k, blocks) + 1 blues,
+ * so neither grows while a block is colored.
+ * 
+ * @param bd The working state.
+ * @param V  The number of real blocks.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Grow_Blocks(Builder *bd, int V) {
+    GhostDag *gd = bd->gd;
+    if (V + 1 <= gd->cap) return true;
+
+    int cap = gd->cap ? gd->cap : 1;
+    while (cap < V + 1) cap *= 2;
+
+    int **arrays[] = { &gd->selParent, &gd->blueScore, &gd->bluesStart, &gd->bluesLen,
+                       &gd->sizesStart, &gd->sizesLen, &bd->mark, &bd->merge };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+        int *grown = (int*)realloc(*arrays[i], cap * sizeof(int));
+        if (!grown) {
+            fprintf(stderr, "Memory GHOSTDAG allocation failed...");
+            return false;
+        }
+        *arrays[i] = grown;
+    }
+
+    // A candidate has at most k blues in its anticone, and no more than blocks.
+    int slots = (gd->k < cap ? gd->k : cap) + 1;
+    int *anti = (int*)realloc(bd->anti, slots * sizeof(int));
+    if (anti) bd->anti = anti;
+    int *antiSize = (int*)realloc(bd->antiSize, slots * sizeof(int));
+    if (antiSize) bd->antiSize = antiSize;
+    Queue *queue = Create_Queue(cap);
+
+    if (!anti || !antiSize || !queue) {
+        fprintf(stderr, "Memory GHOSTDAG allocation failed...");
+        Free_Queue(queue);
+        return false;
+    }
+
+    // The queue is empty between walks, it is swapped for a larger one.
+    Free_Queue(bd->queue);
+    bd->queue = queue;
+
+    // The new slots are not visited by any walk yet.
+    memset(&bd->mark[gd->cap], 0, (cap - gd->cap) * sizeof(int));
+    gd->cap = cap;
+    return true;
+}
+
+/**
+ * @brief Color the virtual block (parents: the tips) into slot V, and
+ * collect the blue set of the graph along its selected parent chain.
+ * 
+ * @param bd The working state.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Color_Virtual(Builder *bd) {
+    GhostDag *gd = bd->gd;
+    Graph *g = bd->g;
+    int *tips = (int*)malloc((g->V ? g->V : 1) * sizeof(int));
+    int tipCnt = 0;
+
+    if (!tips || !Grow_BitSet(gd->blueSet, g->V)) {
+        free(tips);
+        return false;
+    }
+
+    for (int u = Next_Bit(g->tips, 0); u != -1; u = Next_Bit(g->tips, u + 1))
+        tips[tipCnt++] = u;
+    bool ok = Color_Block(bd, g->V, tips, tipCnt);
+    free(tips);
+
+    // Blue set of the graph: the merge set blues along the virtual chain.
+    Clear_BitSet(gd->blueSet);
+    for (int x = g->V; ok && x != -1; x = gd->selParent[x]) {
+        int end = gd->bluesStart[x] + gd->bluesLen[x];
+        for (int j = gd->bluesStart[x]; j < end; j++)
+            Set_Bit(gd->blueSet, gd->blues[j]);
+    }
+
+    gd->virt = ok;
+    return ok;
+}
+
+/**
+ * @brief Free the memory occupied by the GHOSTDAG data.
+ * 
+ * @param gd The data to be freed.
+ */
+void Free_GhostDag(GhostDag *gd) {
+    if (!gd) return;
+    free(gd->selParent);
+    free(gd->blueScore);
+    free(gd->bluesStart);
+    free(gd->bluesLen);
+    free(gd->blues);
+    free(gd->sizesStart);
+    free(gd->sizesLen);
+    free(gd->sizeBlock);
+    free(gd->sizeVal);
+    Free_BitSet(gd->blueSet);
+
+    Builder *bd = gd->build;
+    if (bd) {
+        free(bd->mark);
+        Free_Queue(bd->queue);
+        free(bd->merge);
+        free(bd->anti);
+        free(bd->antiSize);
+        free(bd);
+    }
+    free(gd);
+}
+
+/**
+ * @brief Run GHOSTDAG over an acyclic graph: every block, in topological
+ * order, picks its selected parent and greedily colors its merge set so that
+ * the blues stay a k-cluster. The virtual block (parents: the tips) gives the
+ * blue set of the whole graph. Merge sets are walked only down to the past of
+ * the selected parent, and anticones are checked with the reachability index.
+ * The working state is kept, to color the blocks appended later.
+ * 
+ * @param g  The graph.
+ * @param ri The reachability index of the graph.
+ * @param k  The maximum anticone size of a blue block.
+ * @return A pointer to the GHOSTDAG data, or NULL on a cycle or failure.
+ */
+GhostDag* Create_GhostDag(Graph *g, ReachIndex *ri, int k) {
+    if (!g || !ri || k < 0) return NULL;
+
+    int count = 0;
+    int *order = TopoSort(g, &count);
+    if (!order) return NULL;
+    if (count < g->V) {
+        free(order);
+        return NULL;
+    }
+
+    GhostDag *gd = (GhostDag*)calloc(1, sizeof(GhostDag));
+    Builder *bd = (Builder*)calloc(1, sizeof(Builder));
+
+    if (gd && bd) {
+        gd->k = k;
+        gd->V = g->V;
+        gd->build = bd;
+        gd->blues = (int*)malloc(64 * sizeof(int));
+        gd->sizeBlock = (int*)malloc(64 * sizeof(int));
+        gd->sizeVal = (int*)malloc(64 * sizeof(int));
+        gd->blueSet = Create_BitSet(g->V);
+        bd->gd = gd;
+        bd->g = g;
+        bd->ri = ri;
+        bd->bluesCap = bd->sizesCap = 64;
+    }
+
+    bool ok = gd && bd && gd->blues && gd->sizeBlock && gd->sizeVal && gd->blueSet;
+
+    if (!ok) fprintf(stderr, "Memory GHOSTDAG allocation failed...");
+    ok = ok && Grow_Blocks(bd, g->V);
+
+    // Real blocks in topological order, parents are their forward rows.
+    for (int pass = 0; ok && pass < count; pass++) {
+        int u = order[pass];
+        int first = g->adjList.offset[u];
+        ok = Color_Block(bd, u, &g->adjList.adj[first], g->adjList.offset[u + 1] - first);
+    }
+    free(order);
+
+    // The virtual block merges all the tips.
+    if (!ok || !Color_Virtual(bd)) {
+        if (gd) Free_GhostDag(gd);
+        else free(bd);
+        return NULL;
+    }
+
+    return gd;
+}
+
+/**
+ * @brief Color the blocks appended to the graph since the last call, in
+ * index order (every block comes after its parents). Each one only walks its
+ * own merge set and the selected parent chain, like during Create_GhostDag:
+ * the reachability index must cover them (Extend_Reach). The virtual block
+ * and the blue set are left for Virtual_GhostDag, so that a stream of blocks
+ * does not pay for them every time.
+ * 
+ * @param gd The GHOSTDAG data.
+ * @return true on success, false if the allocation failed.
+ */
+bool Extend_GhostDag(GhostDag *gd) {
+    if (!gd || !gd->build) return false;
+
+    Builder *bd = gd->build;
+    Graph *g = bd->g;
+    if (gd->V == g->V) return true;
+    if (bd->ri->V < g->V || !Grow_Blocks(bd, g->V)) return false;
+
+    // The virtual block was colored last, its entries are dropped.
+    if (gd->virt) {
+        bd->bluesCnt = gd->bluesStart[gd->V];
+        bd->sizesCnt = gd->sizesStart[gd->V];
+        gd->virt = false;
+    }
+
+    for (int v = gd->V; v < g->V; v++) {
+        int first = g->adjList.offset[v];
+        if (!Color_Block(bd, v, &g->adjList.adj[first], g->adjList.offset[v + 1] - first))
+            return false;
+        gd->V = v + 1;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Color the virtual block of the graph again, and rebuild the blue
+ * set, once the appended blocks are colored.
+ * 
+ * @param gd The GHOSTDAG data.
+ * @return true on success, false if the allocation failed.
+ */
+bool Virtual_GhostDag(GhostDag *gd) {
+    if (!gd || !gd->build || gd->V != gd->build->g->V) return false;
+    return gd->virt || Color_Virtual(gd->build);
+}
+
+/**
+ * @brief Get the merge set of a colored block: past(block) without the
+ * selected parent and its past. The walk goes back from the other parents
+ * and stops at the blocks the selected parent reaches, so it costs about
+ * the size of the merge set, not of the history. The blocks are in GHOSTDAG
+ * order (blue score, then name), which is topological.
+ * 
+ * @param gd    The GHOSTDAG data.
+ * @param block The index of the block (V for the virtual block).
+ * @param merge Where to store the merge set, valid until the next call.
+ * @return The size of the merge set, or -1 if the block is not colored.
+ */
+int Get_MergeSet(GhostDag *gd, int block, int **merge) {
+    if (!gd || !gd->build || !merge || block < 0 || block > gd->V) return -1;
+    if (block == gd->V && !gd->virt) return -1;
+
+    Builder *bd = gd->build;
+    Graph *g = bd->g;
+    AdjCSR *adj = &g->adjList;
+    int *parents = NULL, count = 0;
+
+    if (block < gd->V) {
+        parents = &adj->adj[adj->offset[block]];
+        count = adj->offset[block + 1] - adj->offset[block];
+    } else {
+        // The parents of the virtual block are the tips.
+        parents = (int*)malloc((g->V ? g->V : 1) * sizeof(int));
+        if (!parents) return -1;
+        for (int u = Next_Bit(g->tips, 0); u != -1; u = Next_Bit(g->tips, u + 1))
+            parents[count++] = u;
+    }
+
+    bd->mergeLen = 0;
+    if (gd->selParent[block] != -1) {
+        Merge_Set(bd, parents, count, gd->selParent[block]);
+        sortCtx = bd;
+        qsort(bd->merge, bd->mergeLen, sizeof(int), Compare_Merge);
+    }
+
+    if (block == gd->V) free(parents);
+    *merge = bd->merge;
+    return bd->mergeLen;
+}
+
+/**
+ * @brief Write every block of the graph in consensus order, one pass up the
+ * selected parent chain of the virtual block: each chain block comes after
+ * its merge set, itself after the chain below. The merge sets partition the
+ * graph and are in GHOSTDAG order (blue score, then name, Genesis first), so
+ * the order is topological and the same on every run. Each merge set is
+ * walked once and written as soon as it is sorted, nothing else is buffered.
+ * 
+ * @param gd  The GHOSTDAG data, its virtual block up to date.
+ * @param out The writer, one name and a space per block.
+ * @return true on success, false on failure.
+ */
+bool Write_Order(GhostDag *gd, Writer *out) {
+    if (!gd || !gd->build || !gd->virt || !out) return false;
+
+    Graph *g = gd->build->g;
+    int *chain = (int*)malloc((gd->V + 1) * sizeof(int));
+    if (!chain) return false;
+
+    // The chain from the virtual block down to its root.
+    int len = 0;
+    for (int x = gd->V; x != -1; x = gd->selParent[x])
+        chain[len++] = x;
+
+    bool fast = g->rank && g->nameLen && g->ranked == g->V;
+
+    for (int c = len - 1; c >= 0; c--) {
+        int *merge = NULL;
+        int size = Get_MergeSet(gd, chain[c], &merge);
+        if (size <= -1) {
+            free(chain);
+            return false;
+        }
+
+        // The virtual block only brings its merge set.
+        int count = chain[c] == gd->V ? size : size + 1;
+        for (int m = 0; m < count; m++) {
+            int v = m < size ? merge[m] : chain[c];
+            if (fast) Put_Bytes(out, g->idxMap[v], g->nameLen[v]);
+            else Put_Str(out, g->idxMap[v]);
+            Put_Char(out, ' ');
+        }
+    }
+
+    free(chain);
+    return true;
+}
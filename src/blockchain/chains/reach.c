@@ -0,0 +1,350 @@
+#include "../include/reach.h"
+#include "../include/chain_graph.h"
+
+/**
+ * @brief Next value of a xorshift generator (deterministic labels per run).
+ * 
+ * @param state The generator state, updated in place.
+ * @return The next pseudo-random value.
+ */
+static uint32_t Next_Rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/**
+ * @brief Label every vertex with one randomized DFS over the forward adjacency.
+ * post is the post-order rank, pre the pre-order rank, and low the smallest
+ * post rank among the vertex and everything it reaches.
+ * 
+ * @param ri   The index being built.
+ * @param d    The label dimension to fill.
+ * @param seed The seed of the randomized roots and neighbor order.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Label_Dim(ReachIndex *ri, int d, uint32_t seed) {
+    Graph *g = ri->g;
+    AdjCSR *adj = &g->adjList;
+    int V = g->V, dims = ri->dims;
+
+    int *roots = (int*)malloc((V ? V : 1) * sizeof(int));
+    int *cursor = (int*)calloc(V ? V : 1, sizeof(int));
+    int *rot = (int*)malloc((V ? V : 1) * sizeof(int));
+    Stack *stack = Create_Stack(V);
+
+    if (!roots || !cursor || !rot || !stack) {
+        fprintf(stderr, "Memory LABEL allocation failed...");
+        free(roots);
+        free(cursor);
+        free(rot);
+        Free_Stack(stack);
+        return false;
+    }
+
+    // Random order of the roots (Fisher-Yates) and of the neighbors of each vertex.
+    for (int u = 0; u < V; u++) {
+        roots[u] = u;
+        rot[u] = (int)(Next_Rand(&seed) & 0x7fffffff);
+    }
+    for (int u = V - 1; u > 0; u--) {
+        int r = (int)(Next_Rand(&seed) % (uint32_t)(u + 1));
+        int tmp = roots[u];
+        roots[u] = roots[r];
+        roots[r] = tmp;
+    }
+
+    int preCnt = 0, postCnt = 0;
+
+    // A pre rank of -1 marks a vertex not visited yet in this dimension.
+    for (int u = 0; u < V; u++)
+        ri->pre[u * dims + d] = -1;
+
+    for (int r = 0; r < V; r++) {
+        if (ri->pre[roots[r] * dims + d] != -1) continue;
+
+        ri->pre[roots[r] * dims + d] = preCnt++;
+        Push(stack, roots[r]);
+
+        while (!IsEmpty_Stack(stack)) {
+            int u = Top(stack);
+            int deg = adj->offset[u + 1] - adj->offset[u];
+
+            if (cursor[u] < deg) {
+                // Descend into the next neighbor, in rotated order.
+                int v = adj->adj[adj->offset[u] + (rot[u] + cursor[u]) % deg];
+                cursor[u]++;
+                if (ri->pre[v * dims + d] == -1) {
+                    ri->pre[v * dims + d] = preCnt++;
+                    Push(stack, v);
+                }
+                continue;
+            }
+
+            // All neighbors are finished: rank u and take the smallest low below it.
+            Pop(stack);
+            int low = ri->post[u * dims + d] = postCnt++;
+            for (int e = adj->offset[u]; e < adj->offset[u + 1]; e++) {
+                int nlow = ri->low[adj->adj[e] * dims + d];
+                if (nlow < low) low = nlow;
+            }
+            ri->low[u * dims + d] = low;
+        }
+    }
+
+    free(roots);
+    free(cursor);
+    free(rot);
+    Free_Stack(stack);
+    return true;
+}
+
+/**
+ * @brief Build the reachability index of an acyclic graph.
+ * Every vertex gets REACH_DIMS randomized interval labels (GRAIL) and its
+ * topological level, in O(dims * (V + E)) time and O(dims * V) memory.
+ * 
+ * @param g The graph to index.
+ * @return A pointer to the index, or NULL if the graph has a cycle or on failure.
+ */
+ReachIndex* Create_Reach(Graph *g) {
+    if (!g || !g->adjList.offset) return NULL;
+
+    int count = 0;
+    int *order = TopoSort(g, &count);
+    if (!order) return NULL;
+
+    // The labels are only meaningful on a DAG.
+    if (count < g->V) {
+        free(order);
+        return NULL;
+    }
+
+    ReachIndex *ri = (ReachIndex*)malloc(sizeof(ReachIndex));
+    if (!ri) {
+        free(order);
+        return NULL;
+    }
+
+    int V = g->V ? g->V : 1;
+    ri->g = g;
+    ri->V = g->V;
+    ri->cap = V;
+    ri->dims = REACH_DIMS;
+    ri->epoch = 0;
+    ri->low = (int*)malloc(V * REACH_DIMS * sizeof(int));
+    ri->post = (int*)malloc(V * REACH_DIMS * sizeof(int));
+    ri->pre = (int*)malloc(V * REACH_DIMS * sizeof(int));
+    ri->level = (int*)malloc(V * sizeof(int));
+    ri->mark = (int*)calloc(V, sizeof(int));
+    ri->stack = Create_Stack(V);
+
+    if (!ri->low || !ri->post || !ri->pre || !ri->level || !ri->mark || !ri->stack) {
+        fprintf(stderr, "Memory REACH allocation failed...");
+        free(order);
+        Free_Reach(ri);
+        return NULL;
+    }
+
+    // Level of a block: one above its highest parent, in topological order.
+    for (int pass = 0; pass < count; pass++) {
+        int u = order[pass], level = 0;
+        for (int e = g->adjList.offset[u]; e < g->adjList.offset[u + 1]; e++) {
+            if (ri->level[g->adjList.adj[e]] + 1 > level)
+                level = ri->level[g->adjList.adj[e]] + 1;
+        }
+        ri->level[u] = level;
+    }
+    free(order);
+
+    for (int d = 0; d < ri->dims; d++) {
+        if (!Label_Dim(ri, d, 0x9e3779b9u * (uint32_t)(d + 1))) {
+            Free_Reach(ri);
+            return NULL;
+        }
+    }
+
+    return ri;
+}
+
+/**
+ * @brief Label the blocks appended to the graph since the index was built,
+ * in O(dims * parents) each. An appended block has no children, so it takes
+ * its own index as pre and post rank (above every rank so far, and below
+ * those of later blocks): its interval holds everything it reaches, and it
+ * never shows up in a DFS tree, leaving its positive queries to the pruned
+ * search. Its low and level come from its parents.
+ * 
+ * @param ri The index.
+ * @return true on success, false if the allocation failed.
+ */
+bool Extend_Reach(ReachIndex *ri) {
+    if (!ri) return false;
+
+    Graph *g = ri->g;
+    int dims = ri->dims;
+
+    if (g->V > ri->cap) {
+        int cap = ri->cap;
+        while (cap < g->V) cap *= 2;
+
+        int *low = (int*)realloc(ri->low, (size_t)cap * dims * sizeof(int));
+        if (low) ri->low = low;
+        int *post = (int*)realloc(ri->post, (size_t)cap * dims * sizeof(int));
+        if (post) ri->post = post;
+        int *pre = (int*)realloc(ri->pre, (size_t)cap * dims * sizeof(int));
+        if (pre) ri->pre = pre;
+        int *level = (int*)realloc(ri->level, cap * sizeof(int));
+        if (level) ri->level = level;
+        int *mark = (int*)realloc(ri->mark, cap * sizeof(int));
+        if (mark) ri->mark = mark;
+        Stack *stack = Create_Stack(cap);
+
+        if (!low || !post || !pre || !level || !mark || !stack) {
+            fprintf(stderr, "Memory REACH allocation failed...");
+            Free_Stack(stack);
+            return false;
+        }
+
+        // The stack is empty between searches, it is swapped for a larger one.
+        Free_Stack(ri->stack);
+        ri->stack = stack;
+        ri->cap = cap;
+    }
+
+    // Appended blocks come after their parents, in index order.
+    for (int v = ri->V; v < g->V; v++) {
+        int level = 0;
+        for (int d = 0; d < dims; d++) {
+            ri->pre[v * dims + d] = ri->post[v * dims + d] = ri->low[v * dims + d] = v;
+        }
+
+        for (int e = g->adjList.offset[v]; e < g->adjList.offset[v + 1]; e++) {
+            int u = g->adjList.adj[e];
+            if (ri->level[u] + 1 > level) level = ri->level[u] + 1;
+            for (int d = 0; d < dims; d++) {
+                if (ri->low[u * dims + d] < ri->low[v * dims + d])
+                    ri->low[v * dims + d] = ri->low[u * dims + d];
+            }
+        }
+
+        ri->level[v] = level;
+        ri->mark[v] = 0;
+    }
+
+    ri->V = g->V;
+    return true;
+}
+
+/**
+ * @brief Check if the labels of src may contain dst (no false negatives).
+ * 
+ * @param ri  The index.
+ * @param src The index of the source vertex.
+ * @param dst The index of the target vertex.
+ * @return false if dst is surely not reachable from src.
+ */
+static bool May_Reach(ReachIndex *ri, int src, int dst) {
+    int *lowS = &ri->low[src * ri->dims], *lowD = &ri->low[dst * ri->dims];
+    int *postS = &ri->post[src * ri->dims], *postD = &ri->post[dst * ri->dims];
+
+    for (int d = 0; d < ri->dims; d++) {
+        if (lowD[d] < lowS[d] || postD[d] > postS[d])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Check if dst lies in the DFS tree of src in some dimension (no false positives).
+ * 
+ * @param ri  The index.
+ * @param src The index of the source vertex.
+ * @param dst The index of the target vertex.
+ * @return true if dst is surely reachable from src.
+ */
+static bool Tree_Reach(ReachIndex *ri, int src, int dst) {
+    int *preS = &ri->pre[src * ri->dims], *preD = &ri->pre[dst * ri->dims];
+    int *postS = &ri->post[src * ri->dims], *postD = &ri->post[dst * ri->dims];
+
+    for (int d = 0; d < ri->dims; d++) {
+        if (preS[d] <= preD[d] && postD[d] <= postS[d])
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Check if dst is reachable from src along the forward adjacency,
+ * that is, if dst is src or lies in past(src).
+ * The level and interval filters answer most negative queries, the DFS tree
+ * intervals most positive ones; the rest fall back to a pruned DFS, which
+ * pushes every vertex at most once onto a stack sized for all of them.
+ * 
+ * @param ri  The index.
+ * @param src The index of the source vertex.
+ * @param dst The index of the target vertex.
+ * @return true if dst is reachable from src, false otherwise.
+ */
+bool Reaches(ReachIndex *ri, int src, int dst) {
+    if (!ri || src < 0 || dst < 0 || src >= ri->V || dst >= ri->V) return false;
+    if (src == dst) return true;
+
+    // Ancestors sit on strictly lower levels, and inside every interval.
+    if (ri->level[dst] >= ri->level[src]) return false;
+    if (!May_Reach(ri, src, dst)) return false;
+    if (Tree_Reach(ri, src, dst)) return true;
+
+    // New stamp for this search, restart the stamps before they overflow.
+    if (++ri->epoch == INT32_MAX) {
+        memset(ri->mark, 0, ri->V * sizeof(int));
+        ri->epoch = 1;
+    }
+
+    AdjCSR *adj = &ri->g->adjList;
+    bool found = false;
+
+    ri->mark[src] = ri->epoch;
+    Push(ri->stack, src);
+
+    while (!IsEmpty_Stack(ri->stack) && !found) {
+        int u = Top(ri->stack);
+        Pop(ri->stack);
+
+        for (int e = adj->offset[u]; e < adj->offset[u + 1] && !found; e++) {
+            int v = adj->adj[e];
+            if (v == dst) {
+                found = true;
+            } else if (ri->mark[v] != ri->epoch && ri->level[v] > ri->level[dst]
+                       && May_Reach(ri, v, dst)) {
+                // Only descend where the filters still allow reaching dst.
+                ri->mark[v] = ri->epoch;
+                if (Tree_Reach(ri, v, dst)) found = true;
+                else Push(ri->stack, v);
+            }
+        }
+    }
+
+    // Drop what is left from an early exit.
+    Clear_Stack(ri->stack);
+
+    return found;
+}
+
+/**
+ * @brief Free the memory occupied by the index.
+ * 
+ * @param ri The index to be freed.
+ */
+void Free_Reach(ReachIndex *ri) {
+    if (!ri) return;
+    free(ri->low);
+    free(ri->post);
+    free(ri->pre);
+    free(ri->level);
+    free(ri->mark);
+    Free_Stack(ri->stack);
+    free(ri);
+}
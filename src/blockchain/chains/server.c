@@ -0,0 +1,556 @@
+#include "../include/server.h"
+
+#include <sys/stat.h>
+#include <sys/select.h>
+
+// Separators of the tokens of a request.
+#define SERVER_DELIM " :\t\r\n"
+
+// Set by SIGINT / SIGTERM, ends the accept loop of Serve_Socket.
+static volatile sig_atomic_t Stop_Server = 0;
+
+// Per-connection scratch: the sets, the frontier of the searches, the arena
+// of the printed lists, the parents of an append, the pending request bytes
+// and the writer of the answers.
+typedef struct Session {
+    BitSet *past;
+    BitSet *future;
+    BitSet *anticone;
+    Queue *queue;
+    Arena *arena;
+    char **parents;         // Parent names of the current append.
+    int parentCap;          // Allocated parent slots.
+    char *buf;              // Received bytes not answered yet.
+    size_t len;             // Bytes in the buffer.
+    size_t cap;             // Size of the buffer.
+    Writer *out;            // Answers, written once the pending requests are done.
+    bool quit;              // The peer asked to end the session.
+} Session;
+
+// Start argument of a connection thread.
+typedef struct Connection {
+    Server *s;
+    int fd;
+} Connection;
+
+/* ----------------------------------------------------------------------------------- */
+
+/**
+ * @brief Free the scratch of a session (the descriptor is left open).
+ *
+ * @param sess The session.
+ */
+static void Close_Session(Session *sess) {
+    if (!sess) return;
+    Free_BitSet(sess->past);
+    Free_BitSet(sess->future);
+    Free_BitSet(sess->anticone);
+    Free_Queue(sess->queue);
+    Free_Arena(sess->arena);
+    Close_Writer(sess->out);
+    free(sess->parents);
+    free(sess->buf);
+    free(sess);
+}
+
+/**
+ * @brief Allocate the scratch of a session, sized for the graph.
+ *
+ * @param V  The number of vertices of the graph.
+ * @param fd The descriptor the answers are written to.
+ * @return The session, or NULL if allocation fails.
+ */
+static Session* Open_Session(int V, int fd) {
+    Session *sess = (Session*)calloc(1, sizeof(Session));
+    if (!sess) return NULL;
+
+    sess->past = Create_BitSet(V);
+    sess->future = Create_BitSet(V);
+    sess->anticone = Create_BitSet(V);
+    sess->queue = Create_Queue(V);
+    sess->arena = Create_Arena(0);
+    sess->parentCap = 16;
+    sess->parents = (char**)malloc(sess->parentCap * sizeof(char*));
+    sess->cap = SERVER_READ;
+    sess->buf = (char*)malloc(sess->cap);
+    sess->out = Attach_Writer(fd);
+
+    if (!sess->past || !sess->future || !sess->anticone || !sess->queue ||
+        !sess->arena || !sess->parents || !sess->buf || !sess->out) {
+        fprintf(stderr, "Memory SESSION allocation failed...");
+        Close_Session(sess);
+        return NULL;
+    }
+
+    return sess;
+}
+
+/**
+ * @brief Take the read lock of the graph, once its transposed adjacency and
+ * its ranks cover the appended blocks. The first query after an append brings
+ * them up to date under the write lock, for all the sessions.
+ *
+ * @param s The server.
+ * @return true with the read lock held, false (no lock held) on failure.
+ */
+static bool Lock_Fresh(Server *s) {
+    Graph *g = s->g;
+    pthread_rwlock_rdlock(&s->lock);
+
+    while (g->staleT || g->ranked != g->V) {
+        pthread_rwlock_unlock(&s->lock);
+        pthread_rwlock_wrlock(&s->lock);
+        bool ok = Refresh_TCSR(g) && Rank_Names(g);
+        pthread_rwlock_unlock(&s->lock);
+        if (!ok) return false;
+        pthread_rwlock_rdlock(&s->lock);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Fit a set of a session to the vertices of the graph: grown after
+ * appends, created again after a prune shrank the graph.
+ *
+ * @param set The set of the session.
+ * @param n   The number of vertices.
+ * @return true on success, false if allocation fails (the set is kept).
+ */
+static bool Fit_Set(BitSet **set, int n) {
+    if ((*set)->n <= n) return Grow_BitSet(*set, n);
+
+    BitSet *fit = Create_BitSet(n);
+    if (!fit) return false;
+    Free_BitSet(*set);
+    *set = fit;
+    return true;
+}
+
+/**
+ * @brief Answer a past, future or anticone request, holding the read lock.
+ *
+ * @param s    The server.
+ * @param sess The session.
+ * @param kind The requested set ("past", "future" or "anticone").
+ * @param name The name of the node.
+ */
+static void Answer_Set(Server *s, Session *sess, const char *kind, char *name) {
+    Graph *g = s->g;
+    int idx = Get_IdxNode(g, name);
+
+    if (idx <= -1) {
+        Put_Format(sess->out, "error unknown node %s\n", name);
+        return;
+    }
+
+    // The sets follow the appended and the pruned blocks.
+    if (!Fit_Set(&sess->past, g->V) || !Fit_Set(&sess->future, g->V) ||
+        !Fit_Set(&sess->anticone, g->V)) {
+        Put_Str(sess->out, "error out of memory\n");
+        return;
+    }
+
+    Add_Stats(COUNT_QUERIES, 1);
+    BitSet *set = NULL;
+
+    if (kind[0] == 'p') {
+        if (Past_Into(g, idx, sess->past, sess->queue)) set = sess->past;
+    } else if (kind[0] == 'f') {
+        if (Future_Into(g, idx, sess->future, sess->queue)) set = sess->future;
+    } else if (Past_Into(g, idx, sess->past, sess->queue) &&
+               Future_Into(g, idx, sess->future, sess->queue)) {
+        Anticone_Into(idx, sess->past, sess->future, sess->anticone);
+        set = sess->anticone;
+    }
+
+    if (!set) {
+        Put_Str(sess->out, "error search failed\n");
+        return;
+    }
+
+    Put_Format(sess->out, "%s(%s) : ", kind, name);
+    Write_Set(g, sess->arena, set, sess->out);
+}
+
+/**
+ * @brief Append a block to the graph, holding the write lock.
+ *
+ * @param s     The server.
+ * @param sess  The session.
+ * @param save  The state of the tokenizer, past the name of the block.
+ * @param name  The name of the block.
+ */
+static void Answer_Append(Server *s, Session *sess, char **save, char *name) {
+    int count = 0;
+
+    for (char *tok = strtok_r(NULL, SERVER_DELIM, save); tok; tok = strtok_r(NULL, SERVER_DELIM, save)) {
+        if (count == sess->parentCap) {
+            char **grown = (char**)realloc(sess->parents, 2 * sess->parentCap * sizeof(char*));
+            if (!grown) {
+                Put_Str(sess->out, "error out of memory\n");
+                return;
+            }
+            sess->parents = grown;
+            sess->parentCap *= 2;
+        }
+        sess->parents[count++] = tok;
+    }
+
+    pthread_rwlock_wrlock(&s->lock);
+    int v = Append_Block(s->g, name, sess->parents, count);
+    pthread_rwlock_unlock(&s->lock);
+
+    if (v <= -1)
+        Put_Format(sess->out, "error rejected block %s\n", name);
+    else
+        Put_Str(sess->out, "ok\n");
+}
+
+/**
+ * @brief Prune the past of a block, holding the write lock. The other
+ * sessions see the compacted graph from their next request on.
+ *
+ * @param s    The server.
+ * @param sess The session.
+ * @param name The name of the pruning point.
+ */
+static void Answer_Prune(Server *s, Session *sess, char *name) {
+    pthread_rwlock_wrlock(&s->lock);
+    int point = Get_IdxNode(s->g, name);
+    int pruned = point > -1 && s->valid ? Prune_Past(s->g, point) : -1;
+    pthread_rwlock_unlock(&s->lock);
+
+    if (point <= -1)
+        Put_Format(sess->out, "error unknown node %s\n", name);
+    else if (pruned <= -1)
+        Put_Format(sess->out, "error prune failed %s\n", name);
+    else
+        Put_Format(sess->out, "pruned(%s) : %d\n", name, pruned);
+}
+
+/**
+ * @brief Answer one request line, with exactly one answer line (none for an
+ * empty line or quit):
+ *   past X | future X | anticone X   -> kind(X) : names
+ *   tips                             -> tips(G) : names
+ *   valid                            -> correct | impossible
+ *   append X : P1 P2 ...             -> ok
+ *   prune X                          -> pruned(X) : count
+ *   quit                             -> ends the session
+ * Anything else gets an "error ..." line.
+ *
+ * @param s    The server.
+ * @param sess The session.
+ * @param line The request, NUL terminated (tokenized in place).
+ */
+static void Serve_Line(Server *s, Session *sess, char *line) {
+    char *save = NULL;
+    char *req = strtok_r(line, SERVER_DELIM, &save);
+    if (!req) return;
+
+    char *arg = strtok_r(NULL, SERVER_DELIM, &save);
+
+    if (!strcmp(req, "past") || !strcmp(req, "future") || !strcmp(req, "anticone")) {
+        if (!arg || strtok_r(NULL, SERVER_DELIM, &save)) {
+            Put_Format(sess->out, "error usage %s <node>\n", req);
+        } else if (!Lock_Fresh(s)) {
+            Put_Str(sess->out, "error out of memory\n");
+        } else {
+            Answer_Set(s, sess, req, arg);
+            pthread_rwlock_unlock(&s->lock);
+        }
+    } else if (!strcmp(req, "tips") && !arg) {
+        if (!Lock_Fresh(s)) {
+            Put_Str(sess->out, "error out of memory\n");
+        } else {
+            Put_Str(sess->out, "tips(G) : ");
+            Write_Set(s->g, sess->arena, s->g->tips, sess->out);
+            pthread_rwlock_unlock(&s->lock);
+        }
+    } else if (!strcmp(req, "valid") && !arg) {
+        Put_Str(sess->out, s->valid ? "correct\n" : "impossible\n");
+    } else if (!strcmp(req, "append")) {
+        if (!arg) Put_Str(sess->out, "error usage append <node> : <parents>\n");
+        else Answer_Append(s, sess, &save, arg);
+    } else if (!strcmp(req, "prune")) {
+        if (!arg || strtok_r(NULL, SERVER_DELIM, &save)) Put_Str(sess->out, "error usage prune <node>\n");
+        else Answer_Prune(s, sess, arg);
+    } else if (!strcmp(req, "quit") && !arg) {
+        sess->quit = true;
+    } else {
+        Put_Format(sess->out, "error unknown request %s\n", req);
+    }
+}
+
+/**
+ * @brief Answer the requests of a session until its input ends or it quits.
+ * Requests may be pipelined: every complete line received is answered, then
+ * the answers of the whole burst are written at once, before reading again.
+ *
+ * @param s    The server.
+ * @param sess The session.
+ * @param in   The descriptor the requests are read from.
+ * @return true if every answer was written, false otherwise.
+ */
+static bool Run_Session(Server *s, Session *sess, int in) {
+    for (;;) {
+        size_t done = 0;
+        char *end;
+
+        while (!sess->quit && (end = (char*)memchr(sess->buf + done, '\n', sess->len - done))) {
+            *end = '\0';
+            Serve_Line(s, sess, sess->buf + done);
+            done = end - sess->buf + 1;
+        }
+
+        sess->len -= done;
+        memmove(sess->buf, sess->buf + done, sess->len);
+
+        if (sess->quit || !Flush_Writer(sess->out)) break;
+
+        // Keep a byte for the terminator of an unfinished last line.
+        if (sess->len + 1 == sess->cap) {
+            char *grown = sess->cap < SERVER_LINE ? (char*)realloc(sess->buf, 2 * sess->cap) : NULL;
+            if (!grown) {
+                Put_Str(sess->out, "error request too long\n");
+                break;
+            }
+            sess->buf = grown;
+            sess->cap *= 2;
+        }
+
+        ssize_t n = read(in, sess->buf + sess->len, sess->cap - sess->len - 1);
+        if (n < 0 && errno == EINTR) continue;
+
+        if (n <= 0) {
+            // The last request may lack its newline.
+            sess->buf[sess->len] = '\0';
+            if (sess->len) Serve_Line(s, sess, sess->buf);
+            break;
+        }
+
+        sess->len += (size_t)n;
+        Add_Stats(COUNT_READ, (uint64_t)n);
+    }
+
+    return Flush_Writer(sess->out);
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+/**
+ * @brief Create a server over a loaded graph, bringing its transposed
+ * adjacency and its ranks up to date.
+ *
+ * @param g The loaded graph, owned by the caller.
+ * @return A pointer to the server, or NULL on failure.
+ */
+Server* Create_Server(Graph *g) {
+    if (!g || !Refresh_TCSR(g) || !Rank_Names(g)) return NULL;
+
+    Server *s = (Server*)calloc(1, sizeof(Server));
+
+    if (!s) {
+        fprintf(stderr, "Memory SERVER allocation failed...");
+        return NULL;
+    }
+
+    s->g = g;
+    // Appended blocks only point to existing ones, a DAG stays a DAG.
+    s->valid = !HasCycle(g);
+    pthread_rwlock_init(&s->lock, NULL);
+    pthread_mutex_init(&s->connLock, NULL);
+    pthread_cond_init(&s->idle, NULL);
+    return s;
+}
+
+/**
+ * @brief Answer the requests of a stream, on the calling thread.
+ *
+ * @param s   The server.
+ * @param in  The descriptor the requests are read from.
+ * @param out The descriptor the answers are written to.
+ * @return true if every answer was written, false otherwise.
+ */
+bool Serve_Stream(Server *s, int in, int out) {
+    if (!s) return false;
+
+    pthread_rwlock_rdlock(&s->lock);
+    Session *sess = Open_Session(s->g->V, out);
+    pthread_rwlock_unlock(&s->lock);
+    if (!sess) return false;
+
+    bool ok = Run_Session(s, sess, in);
+    Close_Session(sess);
+    return ok;
+}
+
+/**
+ * @brief Main of a connection thread: answer the connection, then close it.
+ *
+ * @param arg The start argument (Connection), freed by the thread.
+ * @return NULL.
+ */
+static void* Serve_Connection(void *arg) {
+    Server *s = ((Connection*)arg)->s;
+    int fd = ((Connection*)arg)->fd;
+    free(arg);
+
+    Serve_Stream(s, fd, fd);
+
+    // Closed under the lock, so the shutdown never reaches a reused descriptor.
+    pthread_mutex_lock(&s->connLock);
+    for (int c = 0; c < s->active; c++) {
+        if (s->conns[c] == fd) {
+            s->conns[c] = s->conns[--s->active];
+            break;
+        }
+    }
+    close(fd);
+    if (!s->active) pthread_cond_signal(&s->idle);
+    pthread_mutex_unlock(&s->connLock);
+    return NULL;
+}
+
+/**
+ * @brief Hand an accepted connection to a new thread.
+ *
+ * @param s  The server.
+ * @param fd The descriptor of the connection.
+ * @return true on success, false (the descriptor closed) on failure.
+ */
+static bool Start_Connection(Server *s, int fd) {
+    Connection *arg = (Connection*)malloc(sizeof(Connection));
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    pthread_mutex_lock(&s->connLock);
+    if (arg && s->active == s->cap) {
+        int cap = s->cap ? 2 * s->cap : 16;
+        int *conns = (int*)realloc(s->conns, cap * sizeof(int));
+        if (conns) {
+            s->conns = conns;
+            s->cap = cap;
+        }
+    }
+
+    bool ok = arg && s->active < s->cap;
+    if (ok) {
+        arg->s = s;
+        arg->fd = fd;
+        s->conns[s->active++] = fd;
+
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        ok = !pthread_create(&thread, &attr, Serve_Connection, arg);
+        pthread_attr_destroy(&attr);
+        if (!ok) s->active--;
+    }
+    pthread_mutex_unlock(&s->connLock);
+
+    if (!ok) {
+        fprintf(stderr, "Couldn't start a connection thread\n");
+        free(arg);
+        close(fd);
+    }
+    return ok;
+}
+
+/**
+ * @brief Signal handler ending the accept loop.
+ *
+ * @param sig The signal.
+ */
+static void Stop_Signal(int sig) {
+    (void)sig;
+    Stop_Server = 1;
+}
+
+/**
+ * @brief Listen on a Unix socket and answer every connection on its own
+ * thread, until SIGINT or SIGTERM. The open connections are then shut down
+ * and waited for, and the socket file is removed.
+ *
+ * @param s    The server.
+ * @param path The path of the socket (a stale socket file is replaced).
+ * @return true on a clean stop, false if the socket couldn't be set up.
+ */
+bool Serve_Socket(Server *s, const char *path) {
+    struct sockaddr_un addr;
+    struct stat st;
+
+    if (!s || !path || strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Invalid socket path");
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (!lstat(path, &st) && S_ISSOCK(st.st_mode)) unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) || listen(fd, SERVER_BACKLOG)) {
+        fprintf(stderr, "Couldn't listen on %s\n", path);
+        if (fd != -1) close(fd);
+        return false;
+    }
+
+    // A peer leaving early must not kill the server, only its session.
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &act, NULL);
+    act.sa_handler = Stop_Signal;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+
+    // The stop signals are only taken while waiting for a connection (and
+    // never by the connection threads, which inherit the mask).
+    sigset_t block, wait;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &wait);
+    sigdelset(&wait, SIGINT);
+    sigdelset(&wait, SIGTERM);
+
+    while (!Stop_Server) {
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(fd, &ready);
+        int n = pselect(fd + 1, &ready, NULL, NULL, NULL, &wait);
+        if (n == -1 && errno != EINTR) break;
+        if (n <= 0) continue;
+
+        int conn = accept(fd, NULL, NULL);
+        if (conn != -1) Start_Connection(s, conn);
+    }
+
+    close(fd);
+    unlink(path);
+
+    // Reads of the open connections return at once, their threads end.
+    pthread_mutex_lock(&s->connLock);
+    for (int c = 0; c < s->active; c++)
+        shutdown(s->conns[c], SHUT_RDWR);
+    while (s->active)
+        pthread_cond_wait(&s->idle, &s->connLock);
+    pthread_mutex_unlock(&s->connLock);
+    return true;
+}
+
+/**
+ * @brief Free a server (the graph is left to the caller).
+ *
+ * @param s The server.
+ */
+void Free_Server(Server *s) {
+    if (!s) return;
+    pthread_rwlock_destroy(&s->lock);
+    pthread_mutex_destroy(&s->connLock);
+    pthread_cond_destroy(&s->idle);
+    free(s->conns);
+    free(s);
+}
@@ -0,0 +1,320 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define GEN_BUFFER (1 << 20)
+
+// Parameters of a synthetic BlockDAG.
+typedef struct GenParams {
+    long blocks;            // Number of blocks, Genesis included.
+    double rate;            // Blocks per second.
+    double delay;           // Network delay in seconds (width ~ rate * delay).
+    int parents;            // Most parents of a block.
+    uint64_t seed;          // Seed of the generator.
+    const char *path;       // Output file, NULL for stdout.
+} GenParams;
+
+// Blocks mined but not yet seen by the network: creation time and parents,
+// in a ring indexed by block number (power of two slots, doubled when full).
+typedef struct Pending {
+    double *time;           // Creation time of every slot.
+    int *count;             // Number of parents of every slot.
+    long *par;              // Parents of every slot (parents per slot).
+    long cap;               // Number of slots.
+} Pending;
+
+// Tips of the network view: blocks seen that no seen block points to.
+typedef struct TipSet {
+    long *tips;             // The tips, in no order.
+    long size;              // Number of tips.
+    long cap;               // Allocated tips.
+    long *pos;              // Position of every block in tips, -1 if not a tip.
+} TipSet;
+
+/**
+ * @brief Next pseudo-random number (splitmix64).
+ *
+ * @param state The state of the generator.
+ * @return A uniform 64-bit number.
+ */
+static uint64_t nextRand(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Uniform number in (0, 1].
+ *
+ * @param state The state of the generator.
+ * @return The number.
+ */
+static double unitRand(uint64_t *state) {
+    return ((nextRand(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Write the name of a block.
+ *
+ * @param fout  The output file.
+ * @param block The block number, 0 for Genesis.
+ */
+static void writeName(FILE *fout, long block) {
+    if (!block) {
+        fputs("Genesis", fout);
+        return;
+    }
+
+    // Digits backwards, faster than printf for tens of millions of names.
+    char digits[24];
+    int len = 0;
+    while (block) {
+        digits[len++] = (char)('0' + block % 10);
+        block /= 10;
+    }
+    putc('B', fout);
+    while (len) putc(digits[--len], fout);
+}
+
+/**
+ * @brief Add a block to the tips.
+ *
+ * @param set   The tips.
+ * @param block The block.
+ * @return true on success, false if the allocation failed.
+ */
+static bool addTip(TipSet *set, long block) {
+    if (set->size == set->cap) {
+        long cap = set->cap ? set->cap * 2 : 64;
+        long *tips = (long*)realloc(set->tips, cap * sizeof(long));
+        if (!tips) return false;
+        set->tips = tips;
+        set->cap = cap;
+    }
+
+    set->pos[block] = set->size;
+    set->tips[set->size++] = block;
+    return true;
+}
+
+/**
+ * @brief Remove a block from the tips, if it is one.
+ *
+ * @param set   The tips.
+ * @param block The block.
+ */
+static void dropTip(TipSet *set, long block) {
+    long at = set->pos[block];
+    if (at < 0) return;
+
+    // Fill the hole with the last tip.
+    long last = set->tips[--set->size];
+    set->tips[at] = last;
+    set->pos[last] = at;
+    set->pos[block] = -1;
+}
+
+/**
+ * @brief Double the slots of the pending ring, keeping the blocks [from, to).
+ *
+ * @param ring    The ring.
+ * @param parents The parents per slot.
+ * @param from    The oldest pending block.
+ * @param to      The next block.
+ * @return true on success, false if the allocation failed.
+ */
+static bool growPending(Pending *ring, int parents, long from, long to) {
+    long cap = ring->cap * 2;
+    double *time = (double*)malloc(cap * sizeof(double));
+    int *count = (int*)malloc(cap * sizeof(int));
+    long *par = (long*)malloc(cap * parents * sizeof(long));
+
+    if (!time || !count || !par) {
+        free(time);
+        free(count);
+        free(par);
+        return false;
+    }
+
+    for (long b = from; b < to; b++) {
+        long old = b & (ring->cap - 1), now = b & (cap - 1);
+        time[now] = ring->time[old];
+        count[now] = ring->count[old];
+        memcpy(par + now * parents, ring->par + old * parents, parents * sizeof(long));
+    }
+
+    free(ring->time);
+    free(ring->count);
+    free(ring->par);
+    ring->time = time;
+    ring->count = count;
+    ring->par = par;
+    ring->cap = cap;
+    return true;
+}
+
+/**
+ * @brief Mine the blocks and write them, one line per block.
+ * Blocks are mined as a Poisson process of the given rate. A block only
+ * sees the blocks mined at least delay seconds before it, and points to
+ * the tips of that view (a random subset of them when there are more
+ * than the parent limit), like miners of a real network do.
+ *
+ * @param p      The parameters.
+ * @param fout   The output file.
+ * @param ring   The pending blocks.
+ * @param set    The tips of the view, holding Genesis.
+ * @param chosen Scratch for the parents of a block.
+ * @return true on success, false if an allocation failed.
+ */
+static bool mineBlocks(GenParams *p, FILE *fout, Pending *ring, TipSet *set, long *chosen) {
+    uint64_t state = p->seed;
+    double now = 0;
+    long seen = 1;
+
+    for (long b = 1; b < p->blocks; b++) {
+        now += -log(unitRand(&state)) / p->rate;
+
+        // Blocks mined more than delay ago reach the view of this block.
+        for (; seen < b && ring->time[seen & (ring->cap - 1)] <= now - p->delay; seen++) {
+            long slot = seen & (ring->cap - 1);
+            for (int k = 0; k < ring->count[slot]; k++)
+                dropTip(set, ring->par[slot * p->parents + k]);
+            if (!addTip(set, seen)) return false;
+        }
+
+        if (b - seen >= ring->cap && !growPending(ring, p->parents, seen, b))
+            return false;
+
+        // Point to the tips, a random subset of them past the limit.
+        int count = set->size < p->parents ? (int)set->size : p->parents;
+        for (int k = 0; k < count; k++) {
+            long pick = k + (long)(nextRand(&state) % (uint64_t)(set->size - k));
+            long tip = set->tips[pick];
+            set->tips[pick] = set->tips[k];
+            set->pos[set->tips[pick]] = pick;
+            set->tips[k] = tip;
+            set->pos[tip] = k;
+            chosen[k] = tip;
+        }
+
+        long slot = b & (ring->cap - 1);
+        ring->time[slot] = now;
+        ring->count[slot] = count;
+        memcpy(ring->par + slot * p->parents, chosen, count * sizeof(long));
+
+        writeName(fout, b);
+        fputs(" :", fout);
+        for (int k = 0; k < count; k++) {
+            putc(' ', fout);
+            writeName(fout, chosen[k]);
+        }
+        putc('\n', fout);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Generate a BlockDAG in the blockdag.in format.
+ *
+ * @param p    The parameters.
+ * @param fout The output file.
+ * @return true on success, false on failure.
+ */
+bool generate(GenParams *p, FILE *fout) {
+    Pending ring = { NULL, NULL, NULL, 1024 };
+    TipSet set = { NULL, 0, 0, (long*)malloc(p->blocks * sizeof(long)) };
+    long *chosen = (long*)malloc(p->parents * sizeof(long));
+
+    ring.time = (double*)malloc(ring.cap * sizeof(double));
+    ring.count = (int*)malloc(ring.cap * sizeof(int));
+    ring.par = (long*)malloc(ring.cap * p->parents * sizeof(long));
+
+    bool ok = set.pos && chosen && ring.time && ring.count && ring.par;
+
+    if (ok) {
+        // Header: the number of blocks, then all the names.
+        fprintf(fout, "%ld\n", p->blocks);
+        for (long b = 0; b < p->blocks; b++) {
+            if (b) putc(' ', fout);
+            writeName(fout, b);
+        }
+        fputs("\nGenesis :\n", fout);
+
+        // Genesis is seen by everyone from the start.
+        for (long b = 0; b < p->blocks; b++) set.pos[b] = -1;
+        ok = addTip(&set, 0) && mineBlocks(p, fout, &ring, &set, chosen) && !ferror(fout);
+    }
+
+    if (!ok) fprintf(stderr, "Couldn't generate the BlockDAG\n");
+    free(set.tips);
+    free(set.pos);
+    free(chosen);
+    free(ring.time);
+    free(ring.count);
+    free(ring.par);
+    return ok;
+}
+
+/**
+ * @brief Print the usage of the generator.
+ */
+void usage(void) {
+    fprintf(stderr,
+        "Usage: ./gendag [-n blocks] [-r rate] [-d delay] [-p parents] [-s seed] [-o file]\n"
+        "  -n  number of blocks, Genesis included (default 100000)\n"
+        "  -r  blocks per second (default 1)\n"
+        "  -d  network delay in seconds, the DAG is about rate * delay wide (default 2)\n"
+        "  -p  most parents of a block (default 8)\n"
+        "  -s  seed (default 1)\n"
+        "  -o  output file (default stdout)\n");
+}
+
+int main(int argc, char **argv) {
+    GenParams p = { 100000, 1.0, 2.0, 8, 1, NULL };
+
+    for (int a = 1; a < argc; a++) {
+        if (a + 1 >= argc || argv[a][0] != '-' || strlen(argv[a]) != 2) {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        char *val = argv[++a];
+        switch (argv[a - 1][1]) {
+            case 'n': p.blocks = atol(val); break;
+            case 'r': p.rate = atof(val); break;
+            case 'd': p.delay = atof(val); break;
+            case 'p': p.parents = atoi(val); break;
+            case 's': p.seed = strtoull(val, NULL, 10); break;
+            case 'o': p.path = val; break;
+            default:
+                usage();
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (p.blocks < 1 || p.blocks > INT32_MAX || p.rate <= 0 || p.delay < 0 || p.parents < 1) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    FILE *fout = p.path ? fopen(p.path, "w") : stdout;
+
+    // Handle opening file failure.
+    if (!fout) {
+        fprintf(stderr, "Couldn't open file for writing");
+        return EXIT_FAILURE;
+    }
+
+    setvbuf(fout, NULL, _IOFBF, GEN_BUFFER);
+    bool ok = generate(&p, fout);
+
+    if (fout != stdout) ok = !fclose(fout) && ok;
+    else ok = !fflush(fout) && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
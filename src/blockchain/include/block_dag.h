@@ -2,12 +2,22 @@
 #define _BLOCKDAG_H_
 
 #include "../../libs/include/list.h"
+#include "../../libs/include/hash.h"
+#include "../../libs/include/stats.h"
+#include "../../libs/include/arena.h"
+#include "../../libs/include/pool.h"
+#include "../../libs/include/bitset.h"
 #include "../../libs/include/stack.h"
 #include "../../libs/include/queue.h"
 #include "../../libs/include/graph.h"
+#include "../../libs/include/snapshot.h"
+#include "../../libs/include/writer.h"
 
 #include "./chain_graph.h"
 #include "./chain_list.h"
+#include "./reach.h"
+#include "./ghostdag.h"
 #include "./evolve.h"
+#include "./server.h"
 
 #endif /* _BLOCKDAG_H_ */
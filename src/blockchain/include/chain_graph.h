@@ -3,11 +3,21 @@
 
 #include "./block_dag.h"
 
-// Function to find the path visited from a source node in the graph.
-ListVal*    Path_Vis    (Graph *g, int s);
+#define BFS_ALPHA 14    // Go bottom-up once frontier edges > unexplored edges / BFS_ALPHA.
+#define BFS_BETA 24     // Go top-down again once the frontier < V / BFS_BETA.
+#define BFS_GRAIN 256   // Frontier nodes per item of a top-down level.
+#define BFS_WORDS 16    // Visited words per item of a bottom-up level.
+#define BFS_FLUSH 64    // Nodes a worker buffers before appending them.
+
+// Function to find the set visited from a source node along an adjacency.
+BitSet*     Path_Vis    (Graph *g, AdjCSR *adj, int s);
+// Same search, into caller owned buffers (per-thread scratch).
+bool        Path_Into   (Graph *g, AdjCSR *adj, int s, BitSet *vis, Queue *queue);
+// Same search level by level on a pool, switching to bottom-up levels on wide frontiers.
+bool        Path_Levels (Graph *g, AdjCSR *adj, AdjCSR *rev, int s, BitSet *vis, Pool *pool);
 // Function to check if a graph contains a cycle.
 bool        HasCycle    (Graph *g);
-// Recursive function used in topological sorting to detect cycles.
-bool        TopoSort    (Graph *g, int src, bool *vis, bool *stack);
+// Topological order (parents first) of the graph, by in-degree (Kahn).
+int*        TopoSort    (Graph *g, int *count);
 
 #endif /* _CHAIN_GRAP_H_ */
@@ -3,17 +3,18 @@
 
 #include "./block_dag.h"
 
-// Create a new ordered list containing a single value.
-ListVal*    Create_Ord      (char *name);
-// Insert a value into an ordered list while maintaining the order.
-ListVal*    Insert_Ord      (ListVal *list, char *name);
+// A set with at least V / RANK_DENSE members is printed by scanning all the ranks.
+#define RANK_DENSE 16
 
-// Check if a value exists in an ordered list.
-bool        Contains_Ord    (ListVal *list, char *name);
-
-// Print the values in an ordered list to a file.
-void        Print_Ord       (ListVal *list, FILE *fout);
-// Free the memory allocated for an ordered list.
-void        Free_Ord        (ListVal *list);
+// Compare two names in list order (Genesis first, then lexicographic).
+int         Compare_Ord     (char *str1, char *str2);
+// Rank every name of the graph in list order, once (O(V log V)).
+bool        Rank_Names      (Graph *g);
+// Compare two vertices in list order, by rank when the ranks are up to date.
+int         Order_Nodes     (Graph *g, int u, int v);
+// Print the names of a vertex set to a writer, in list order.
+void        Print_Set       (Graph *g, BitSet *set, Writer *out);
+// Same, with the list drawn from a given arena (one per thread).
+void        Write_Set       (Graph *g, Arena *arena, BitSet *set, Writer *out);
 
 #endif /* _CHAIN_LIST_H_ */
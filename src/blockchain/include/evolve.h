@@ -3,14 +3,38 @@
 
 #include "./block_dag.h"
 
+#define CONE_LANES 4
+#define CONE_BATCH (64 * CONE_LANES)
+
 // Returns the past set of nodes reachable from a given vertex.
-ListVal*    Past        (Graph *g, int src);
+BitSet*     Past        (Graph *g, int src);
 // Returns the future set of nodes that can reach a given vertex.
-ListVal*    Future      (Graph *g, int src);
+BitSet*     Future      (Graph *g, int src);
+
+// Past set into caller owned buffers (per-thread scratch).
+bool        Past_Into   (Graph *g, int src, BitSet *past, Queue *queue);
+// Future set into caller owned buffers, the transposed adjacency must be up to date.
+bool        Future_Into (Graph *g, int src, BitSet *future, Queue *queue);
+// Past and future of a single vertex on a pool (direction-optimizing BFS).
+bool        Past_Levels   (Graph *g, Pool *pool, int src, BitSet *past);
+bool        Future_Levels (Graph *g, Pool *pool, int src, BitSet *future);
+
+// Check if a node is in the past of a given vertex, using a reachability index.
+bool        InPast      (ReachIndex *ri, int src, int node);
+// Check if a node is in the future of a given vertex, using a reachability index.
+bool        InFuture    (ReachIndex *ri, int src, int node);
 
 // The tips set contains nodes with no incoming edges.
-ListVal*    Tips        (Graph *g);
+BitSet*     Tips        (Graph *g);
 // The anticone set contains nodes that are neither in the past nor in the future.
-ListVal*    Anticone    (Graph *g, int src, ListVal *past, ListVal *future);
+BitSet*     Anticone    (Graph *g, int src, BitSet *past, BitSet *future);
+// Anticone into a caller owned set.
+void        Anticone_Into (int src, BitSet *past, BitSet *future, BitSet *anticone);
+
+// Sizes of past, future and anticone of every block, CONE_BATCH blocks per sweep.
+bool        Cone_Sizes  (Graph *g, Pool *pool, int *past, int *future, int *anticone);
+
+// Prune the past of a block and compact the graph, returns the pruned count or -1.
+int         Prune_Past  (Graph *g, int point);
 
 #endif /* _EVOLVE_H_ */
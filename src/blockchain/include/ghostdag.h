@@ -0,0 +1,41 @@
+#ifndef _GHOSTDAG_H_
+#define _GHOSTDAG_H_
+
+#include "../../libs/include/graph.h"
+#include "../../libs/include/writer.h"
+#include "./reach.h"
+
+// Definition of the GHOSTDAG data of every block (greedy maximum k-cluster).
+// Slot V holds the virtual block, whose parents are the tips of the graph.
+typedef struct GhostDag {
+    int k;                  // Maximum anticone size of a blue block.
+    int V;                  // Number of real blocks.
+    int cap;                // Allocated block slots (virtual included).
+    bool virt;              // The virtual block and the blue set cover the V blocks.
+    int *selParent;         // Selected parent of every block (-1 for roots).
+    int *blueScore;         // Number of blue blocks in the past of every block.
+    int *bluesStart;        // Start of the merge set blues of every block in blues.
+    int *bluesLen;          // Number of merge set blues of every block.
+    int *blues;             // Merge set blues, selected parent first.
+    int *sizesStart;        // Start of the blue anticone sizes of every block.
+    int *sizesLen;          // Number of blue anticone sizes of every block.
+    int *sizeBlock;         // Blue block of every recorded anticone size.
+    int *sizeVal;           // Recorded anticone size, within the blues of the owner.
+    BitSet *blueSet;        // Blue set of the whole graph (blues of the virtual).
+    struct Builder *build;  // Working state, kept to color appended blocks.
+} GhostDag;
+
+// Run GHOSTDAG with parameter k over an acyclic graph and its reachability index.
+GhostDag*   Create_GhostDag (Graph *g, ReachIndex *ri, int k);
+// Color the blocks appended to the graph (reachability index extended first).
+bool        Extend_GhostDag (GhostDag *gd);
+// Color the virtual block again and rebuild the blue set, after Extend_GhostDag.
+bool        Virtual_GhostDag(GhostDag *gd);
+// Merge set of a block without its selected parent, in GHOSTDAG order (-1 on failure).
+int         Get_MergeSet    (GhostDag *gd, int block, int **merge);
+// Write every block in consensus order: the merge sets along the virtual chain.
+bool        Write_Order     (GhostDag *gd, Writer *out);
+// Free the memory occupied by the GHOSTDAG data.
+void        Free_GhostDag   (GhostDag *gd);
+
+#endif /* _GHOSTDAG_H_ */
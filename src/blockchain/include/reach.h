@@ -0,0 +1,34 @@
+#ifndef _REACH_H_
+#define _REACH_H_
+
+#include "../../libs/include/graph.h"
+#include "../../libs/include/stack.h"
+
+// Number of randomized interval labels per vertex.
+#define REACH_DIMS 3
+
+// Definition of a reachability index (GRAIL interval labels and levels).
+typedef struct ReachIndex {
+    Graph *g;               // The indexed graph (borrowed).
+    int V;                  // Number of indexed vertices.
+    int cap;                // Allocated vertex slots.
+    int dims;               // Number of labels per vertex.
+    int *low;               // V * dims: smallest post rank reachable from the vertex.
+    int *post;              // V * dims: post-order rank in a randomized DFS.
+    int *pre;               // V * dims: pre-order rank in the same DFS.
+    int *level;             // Topological level, Genesis at 0.
+    int *mark;              // Scratch visit stamps for the fallback search.
+    int epoch;              // Stamp of the current fallback search.
+    Stack *stack;           // Scratch stack for the fallback search.
+} ReachIndex;
+
+// Build the reachability index of an acyclic graph (NULL on a cycle).
+ReachIndex* Create_Reach    (Graph *g);
+// Label the blocks appended to the graph since the index was built.
+bool        Extend_Reach    (ReachIndex *ri);
+// Check if dst is reachable from src along the forward adjacency.
+bool        Reaches         (ReachIndex *ri, int src, int dst);
+// Free the memory occupied by the index.
+void        Free_Reach      (ReachIndex *ri);
+
+#endif /* _REACH_H_ */
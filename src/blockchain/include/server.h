@@ -0,0 +1,40 @@
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+
+#include "./block_dag.h"
+
+#define SERVER_BACKLOG 64
+#define SERVER_READ (1 << 16)
+#define SERVER_LINE (1 << 20)
+
+// Definition of a resident query server: the graph is loaded once, then
+// answers line requests from any number of connections. Queries share the
+// graph (read lock), appends own it (write lock), and the transposed
+// adjacency and the ranks are brought up to date by the next query.
+typedef struct Server {
+    Graph *g;                   // The loaded graph.
+    bool valid;                 // The graph is a DAG (appends keep it one).
+    pthread_rwlock_t lock;      // Guards the graph.
+    pthread_mutex_t connLock;   // Guards the connections below.
+    pthread_cond_t idle;        // Signals that the last connection ended.
+    int *conns;                 // Descriptors of the open connections.
+    int active;                 // Number of open connections.
+    int cap;                    // Allocated connection slots.
+} Server;
+
+// Create a server over a loaded graph (owned by the caller).
+Server*     Create_Server   (Graph *g);
+// Answer the requests of one stream (stdin / stdout) until it ends.
+bool        Serve_Stream    (Server *s, int in, int out);
+// Answer the connections of a Unix socket until SIGINT or SIGTERM.
+bool        Serve_Socket    (Server *s, const char *path);
+// Free a server, once every connection ended.
+void        Free_Server     (Server *s);
+
+#endif /* _SERVER_H_ */
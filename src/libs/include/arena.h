@@ -0,0 +1,41 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "stats.h"
+
+#define ARENA_CHUNK 65536
+#define ARENA_ALIGN 8
+
+// Definition of a chunk of arena memory, handed out front to back.
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;    // Previously filled chunk.
+    size_t size;                // Bytes of data.
+    size_t used;                // Bytes handed out.
+    char data[];                // The memory itself.
+} ArenaChunk;
+
+// Definition of a region allocator: no per-object free, everything
+// allocated from it is released at once (Reset_Arena / Free_Arena).
+typedef struct Arena {
+    ArenaChunk *head;           // Chunk currently handed out from.
+    size_t chunk;               // Default chunk size.
+} Arena;
+
+// Create an arena growing by chunks of (at least) the given size.
+Arena*      Create_Arena    (size_t chunk);
+// Allocate aligned memory from the arena.
+void*       Alloc_Arena     (Arena *arena, size_t size);
+// Copy a string of a given length into the arena, NUL terminated.
+char*       Strndup_Arena   (Arena *arena, const char *str, size_t len);
+// Release everything allocated from the arena, keeping one chunk for reuse.
+void        Reset_Arena     (Arena *arena);
+// Free the arena and everything allocated from it.
+void        Free_Arena      (Arena *arena);
+
+#endif /* _ARENA_H_ */
@@ -0,0 +1,51 @@
+#ifndef _BITSET_H_
+#define _BITSET_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "stats.h"
+
+#define BITS_PER_WORD 64
+
+// Definition of a dense set of vertex indices, packed in 64-bit words.
+typedef struct BitSet {
+    int n;                  // Number of bits (universe size).
+    int words;              // Number of 64-bit words.
+    int cap;                // Allocated 64-bit words.
+    uint64_t *bits;         // Packed bits, the tail of the last word stays clear.
+} BitSet;
+
+// Create an empty set over the indices [0, n).
+BitSet*     Create_BitSet       (int n);
+// Create a copy of a set.
+BitSet*     Copy_BitSet         (BitSet *set);
+// Free the memory occupied by a set.
+void        Free_BitSet         (BitSet *set);
+// Grow the universe of a set to [0, n), the new indices start out absent.
+bool        Grow_BitSet         (BitSet *set, int n);
+
+// Add an index to the set.
+void        Set_Bit             (BitSet *set, int idx);
+// Remove an index from the set.
+void        Clear_Bit           (BitSet *set, int idx);
+// Check if an index is in the set.
+bool        Test_Bit            (BitSet *set, int idx);
+
+// dst = dst | src, word-wise.
+void        Union_BitSet        (BitSet *dst, BitSet *src);
+// dst = dst & ~src, word-wise.
+void        AndNot_BitSet       (BitSet *dst, BitSet *src);
+// set = {}, keeping the memory.
+void        Clear_BitSet        (BitSet *set);
+// set = ~set, restricted to [0, n).
+void        Complement_BitSet   (BitSet *set);
+// Number of indices in the set (popcount).
+int         Count_BitSet        (BitSet *set);
+// The smallest index >= from in the set, or -1 if none.
+int         Next_Bit            (BitSet *set, int from);
+
+#endif /* _BITSET_H_ */
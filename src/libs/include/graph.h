@@ -6,40 +6,96 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hash.h"
+#include "stats.h"
+#include "arena.h"
+#include "bitset.h"
+#include "pool.h"
 
 #define MAX_COMM_LEN 3
 #define MAX_LINE_LEN 256
 #define DELIM_OPER " :\n"
 
-// Definition of a graph node.
-typedef struct GraphNode {
-    char *name;             // Node name identifier.
-    struct GraphNode *next;
-} GraphNode;
+// Chunks of the edge section per loading thread, and the smallest chunk (bytes).
+#define LOAD_SPLIT 4
+#define LOAD_CHUNK (1 << 20)
+
+// Compressed sparse row adjacency: the neighbors of vertex u are
+// adj[offset[u]] .. adj[offset[u + 1] - 1], stored as vertex indices.
+typedef struct AdjCSR {
+    int *offset;            // Row offsets (V + 1 entries).
+    int *adj;               // Neighbor indices (E entries).
+} AdjCSR;
+
+// Growable list of edges collected while parsing, compacted into CSR once.
+typedef struct EdgeBuf {
+    int *src;               // Source vertex of each edge.
+    int *dst;               // Destination vertex of each edge.
+    int len;                // Number of stored edges.
+    int cap;                // Allocated capacity.
+    bool failed;            // An edge was dropped, the buffer could not grow.
+} EdgeBuf;
 
 // Definition of a graph.
 typedef struct Graph {
     int V;                  // Number of vertices.
+    int E;                  // Number of edges.
     char **idxMap;          // Mapping of vertex names to indices.
-    GraphNode **adjList;    // Adjacency list representation of the graph.
+    HashMap *idxHash;       // Symbol table from vertex names to indices.
+    AdjCSR adjList;         // Adjacency (CSR) representation of the graph.
+    AdjCSR adjListT;        // Adjacency (CSR) of the transposed graph.
+    int capV;               // Allocated vertex slots (idxMap, offsets).
+    int capE;               // Allocated edge slots (forward adjacency).
+    BitSet *tips;           // Vertices without children, kept up to date on append.
+    bool staleT;            // The transposed adjacency misses appended blocks.
+    char *map;              // Private mapping of the input, the names are views into it.
+    size_t mapLen;          // Length of the mapping.
+    Arena *arena;           // Names not in the mapping, released with the graph.
+    Arena *scratch;         // Per-query memory (result lists), reset after each use.
+    int *rank;              // Rank of every name in list order (Genesis first).
+    int *byRank;            // Vertex of every rank.
+    int *nameLen;           // Length of every ranked name, copied out without strlen.
+    int ranked;             // Vertices covered by the ranks (stale once != V).
+    int *prunedPast;        // Pruned blocks in the past of every block (NULL if never pruned).
+    int pruned;             // Number of pruned blocks.
 } Graph;
 
 // Get the index of a vertex by its name.
 int         Get_IdxNode         (Graph *g, char *name);
+// Get the index of a vertex by a token that is not NUL terminated.
+int         Get_IdxToken        (Graph *g, const char *name, size_t len);
 // Get the name of a vertex by its index.
 char*       Get_ValNode         (Graph *g, int idx);
 
 //Create an array for mapping vertex names to indices.
-char**      Create_IdxMap       (int V, char *buffer);
-// Add an edge between two vertices in the graph.
-void        Add_Edge            (Graph *g, char *V1, char *V2);
-
-// Create an empty graph.
-Graph*      Create_Graph        (void);
-// Create the transposed graph of a given graph.
-Graph*      Create_TGraph       (Graph *g);
+char**      Create_IdxMap       (int V, char *buffer, size_t len, Arena *arena);
+// Add an edge between two vertices (by index) to the edge buffer.
+void        Add_Edge            (EdgeBuf *edges, int v1, int v2);
+// Compact the collected edges into the CSR adjacency of the graph.
+bool        Create_CSR          (Graph *g, EdgeBuf *parts, int count);
+// Build the transposed CSR adjacency from the forward one.
+bool        Create_TCSR         (Graph *g);
+// Rebuild the transposed CSR adjacency if blocks were appended since.
+bool        Refresh_TCSR        (Graph *g);
+// Build the tips set from the transposed adjacency.
+bool        Create_Tips         (Graph *g);
+// Free the memory occupied by an edge buffer.
+void        Free_EdgeBuf        (EdgeBuf *edges);
+
+// Load the graph of blockdag.in (text or snapshot), the edge lines parsed on a pool.
+Graph*      Create_Graph        (Pool *pool);
 // Create a graph with adjacency list representation.
-Graph*      Create_AdjList      (int V, char *buffer);
+Graph*      Create_AdjList      (int V, char *buffer, size_t len);
+
+// Append a new block with its parents, returns its index or -1 if rejected.
+int         Append_Block        (Graph *g, char *name, char **parents, int count);
+// Drop a set of vertices and compact the graph (kept vertices renumbered in order).
+bool        Compact_Graph       (Graph *g, BitSet *drop);
 
 // Free the memory occupied by a graph.
 void        Free_Graph          (Graph *g);
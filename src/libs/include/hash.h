@@ -0,0 +1,31 @@
+#ifndef _HASH_H_
+#define _HASH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Definition of an open-addressing (linear probing) hash map from names to indices.
+typedef struct HashMap {
+    char **keys;            // Borrowed key strings, NULL marks an empty slot.
+    uint32_t *hashes;       // Cached hash of every stored key.
+    int *vals;              // Value stored for every key.
+    int cap;                // Number of slots (power of two).
+    int size;               // Number of stored keys.
+} HashMap;
+
+// Hash a string of a given length (FNV-1a).
+uint32_t    Hash_Str        (const char *key, size_t len);
+
+// Create a hash map able to hold at least cap keys without growing.
+HashMap*    Create_HashMap  (int cap);
+// Insert a key, returns false if it is already present or on failure.
+bool        Put_HashMap     (HashMap *map, char *key, int val);
+// Get the value of a key of a given length, or -1 if missing.
+int         Get_HashMap     (HashMap *map, const char *key, size_t len);
+// Free the memory occupied by the hash map (not the keys).
+void        Free_HashMap    (HashMap *map);
+
+#endif /* _HASH_H_ */
@@ -19,12 +19,6 @@ typedef struct List {
     ListNode *head;
 } List;
 
-// Definition of a linked list node for values.
-typedef struct ListVal {
-    char *name;         // Node name identifier.
-    struct ListVal *next;
-} ListVal;
-
 // Create a new empty list.
 List* Create_List(void);
 // Check if the list is empty.
@@ -0,0 +1,47 @@
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define POOL_GRAIN_DIV 8
+// Most workers of a pool, a larger request is rejected before any thread starts.
+#define POOL_MAX_SIZE 1024
+
+// A task of a job: process one item on behalf of one worker (0 .. size - 1).
+typedef void (*PoolTask)(void *ctx, int worker, int item);
+
+// Definition of a fixed pool of worker threads running jobs over item ranges.
+// Items are claimed in small chunks from a shared atomic counter, so workers
+// that finish early keep taking items from the rest (dynamic load balancing).
+typedef struct Pool {
+    pthread_t *threads;     // Worker threads (size - 1, the caller is worker 0).
+    int size;               // Number of workers, the caller included.
+    pthread_mutex_t lock;   // Guards the job fields below.
+    pthread_cond_t wake;    // Signals a new job, or shutdown, to the workers.
+    pthread_cond_t idle;    // Signals the caller that the workers are done.
+    PoolTask task;          // Task of the current job.
+    void *ctx;              // Context of the current job.
+    int count;              // Items of the current job.
+    int grain;              // Items claimed at once.
+    int next;               // Next unclaimed item (atomic).
+    int busy;               // Workers still running the current job.
+    unsigned job;           // Generation of the current job.
+    bool stop;              // The pool is shutting down.
+} Pool;
+
+// Number of online cores.
+int         Cores_Pool      (void);
+// Create a pool of size workers (the calling thread included).
+Pool*       Create_Pool     (int size);
+// Run task on the items [0, count) and wait until all of them are done.
+void        Run_Pool        (Pool *pool, int count, PoolTask task, void *ctx);
+// Stop the workers and free the pool.
+void        Free_Pool       (Pool *pool);
+
+#endif /* _POOL_H_ */
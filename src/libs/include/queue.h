@@ -1,22 +1,35 @@
 #ifndef _QUEUE_H_
 #define _QUEUE_H_
 
-#include "list.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
 
-// Define Queue as an alias for List.
-typedef List Queue;
+#include "stats.h"
 
-// Create a new queue.
-Queue*      Create_Queue    (void);
+// Definition of a queue as a growable ring buffer of vertex indices.
+typedef struct Queue {
+    int *data;              // Ring buffer of elements.
+    int cap;                // Allocated slots (power of two).
+    int head;               // Slot of the front element.
+    int size;               // Number of stored elements.
+} Queue;
+
+// Create a new queue able to hold cap elements without growing.
+Queue*      Create_Queue    (int cap);
 // Check if the queue is empty.
 bool        IsEmpty_Queue   (Queue *queue);
+// Remove every element, keeping the buffer.
+void        Clear_Queue     (Queue *queue);
 // Free the memory occupied by the queue and its elements.
 void        Free_Queue      (Queue *queue);
 
 // Get the front element of the queue.
 int         Front           (Queue *queue);
-// Enqueue an element onto the queue.
-void        Enqueue         (Queue *queue, int elem);
+// Enqueue an element onto the queue, returns false on failure.
+bool        Enqueue         (Queue *queue, int elem);
 // Dequeue and remove the front element from the queue.
 void        Dequeue         (Queue *queue);
 
@@ -0,0 +1,35 @@
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "graph.h"
+
+#define SNAP_MAGIC "BDAGSNAP"
+#define SNAP_VERSION 1u
+
+// Header of a binary graph snapshot, followed by 8-byte aligned sections:
+// string pool, name offsets, forward CSR (offset, adj), transposed CSR (offset, adj).
+// Integers are stored in the native byte order of the writer.
+typedef struct SnapHeader {
+    char magic[8];          // SNAP_MAGIC, not NUL terminated.
+    uint32_t version;       // SNAP_VERSION.
+    uint32_t V;             // Number of vertices.
+    uint32_t E;             // Number of edges.
+    uint32_t reserved;      // Zero, keeps the header 8-byte aligned.
+    uint64_t poolLen;       // Bytes of NUL terminated names in the string pool.
+    uint64_t checksum;      // Checksum of every byte after the header.
+} SnapHeader;
+
+// Check if a buffer starts with the snapshot magic.
+bool        Is_Snapshot     (const char *buffer, size_t len);
+// Load a graph from a mapped snapshot, the graph borrows the mapping.
+Graph*      Load_Snapshot   (char *map, size_t len);
+// Write a graph to a snapshot file.
+bool        Save_Snapshot   (Graph *g, const char *path);
+
+#endif /* _SNAPSHOT_H_ */
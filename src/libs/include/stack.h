@@ -1,22 +1,32 @@
 #ifndef _STACK_H_
 #define _STACK_H_
 
-#include "list.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
 
-// Define Stack as an alias for List.
-typedef List Stack;
+// Definition of a stack as a growable array of vertex indices.
+typedef struct Stack {
+    int *data;              // Elements, the top is data[size - 1].
+    int cap;                // Allocated slots.
+    int size;               // Number of stored elements.
+} Stack;
 
-// Create a new stack.
-Stack*      Create_Stack    (void);
+// Create a new stack able to hold cap elements without growing.
+Stack*      Create_Stack    (int cap);
 // Check if the stack is empty.
 bool        IsEmpty_Stack   (Stack *stack);
+// Remove every element, keeping the array.
+void        Clear_Stack     (Stack *stack);
 // Free the memory occupied by the stack and its elements.
 void        Free_Stack      (Stack *stack);
 
 // Get the top element of the stack.
 int         Top             (Stack *stack);
-// Push an element onto the stack.
-void        Push            (Stack *stack, int elem);
+// Push an element onto the stack, returns false on failure.
+bool        Push            (Stack *stack, int elem);
 // Pop and remove the top element from the stack.
 void        Pop             (Stack *stack);
 
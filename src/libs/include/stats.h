@@ -0,0 +1,90 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sys/resource.h>
+
+// Timed phases of a run (wall time, summed over the threads running them).
+typedef enum StatPhase {
+    PHASE_LOAD,             // Create_Graph: mapping, parsing, building (all below).
+    PHASE_IDXMAP,           // Names line: index map and symbol table.
+    PHASE_EDGES,            // Edge lines: tokens, lookups, edge buffer.
+    PHASE_CSR,              // Forward CSR compaction.
+    PHASE_TCSR,             // Transposed CSR build.
+    PHASE_TOPO,             // Topological sorts.
+    PHASE_SEARCH,           // Past / future searches.
+    PHASE_SETS,             // Set construction: anticone, tips, sorted lists.
+    PHASE_CONES,            // Cone sizes of every block.
+    PHASE_OUTPUT,           // Writing the results.
+    PHASE_COUNT
+} StatPhase;
+
+// Counters of a run.
+typedef enum StatCounter {
+    COUNT_EDGES,            // Edges visited by the searches.
+    COUNT_NODES,            // Nodes visited by the searches.
+    COUNT_LOOKUPS,          // Symbol table lookups.
+    COUNT_ALLOCS,           // Heap allocations of sets, queues and arena chunks.
+    COUNT_READ,             // Bytes read (graph, query files and requests).
+    COUNT_WRITTEN,          // Bytes written (results and snapshots).
+    COUNT_QUERIES,          // Answered queries.
+    COUNT_COUNT
+} StatCounter;
+
+// Definition of the statistics of a run, only updated once enabled.
+typedef struct Stats {
+    bool on;                        // Statistics are collected.
+    uint64_t start;                 // Clock at Enable_Stats (ns).
+    uint64_t time[PHASE_COUNT];     // Nanoseconds spent in every phase.
+    uint64_t calls[PHASE_COUNT];    // Times every phase was entered.
+    uint64_t count[COUNT_COUNT];    // Counters.
+} Stats;
+
+// The statistics of the process.
+extern Stats Global_Stats;
+
+// Monotonic clock in nanoseconds.
+uint64_t    Clock_Stats     (void);
+// Start collecting statistics.
+void        Enable_Stats    (void);
+// Write the statistics as a single JSON object.
+void        Report_Stats    (FILE *fout, const char *command);
+
+/**
+ * @brief Start timing a phase, a no-op (no clock read) when disabled.
+ *
+ * @return The start time, to hand to Stop_Stats.
+ */
+static inline uint64_t Start_Stats(void) {
+    return Global_Stats.on ? Clock_Stats() : 0;
+}
+
+/**
+ * @brief Stop timing a phase started with Start_Stats.
+ *
+ * @param phase The phase.
+ * @param start The start time.
+ */
+static inline void Stop_Stats(StatPhase phase, uint64_t start) {
+    if (!Global_Stats.on) return;
+    __atomic_fetch_add(&Global_Stats.time[phase], Clock_Stats() - start, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&Global_Stats.calls[phase], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Add to a counter. Hot loops count locally and add once.
+ *
+ * @param counter The counter.
+ * @param n       The amount.
+ */
+static inline void Add_Stats(StatCounter counter, uint64_t n) {
+    if (!Global_Stats.on) return;
+    __atomic_fetch_add(&Global_Stats.count[counter], n, __ATOMIC_RELAXED);
+}
+
+#endif /* _STATS_H_ */
@@ -0,0 +1,56 @@
+#ifndef _WRITER_H_
+#define _WRITER_H_
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <stdbool.h>
+
+#include "stats.h"
+
+#define WRITER_BUFFER (1 << 20)
+#define WRITER_LINE 256
+
+// Definition of a buffered output: bytes are copied into a large buffer and
+// handed to the file with a single write(2) per buffer. A writer without a
+// file keeps everything in memory (the buffer grows), to be copied later.
+typedef struct Writer {
+    int fd;                 // Output file descriptor, -1 for a memory writer.
+    bool owned;             // The descriptor is closed with the writer.
+    bool failed;            // A write or an allocation failed.
+    char *buf;              // Pending bytes (all the bytes of a memory writer).
+    size_t len;             // Bytes in the buffer.
+    size_t cap;             // Size of the buffer.
+    uint64_t written;       // Bytes handed to the file so far.
+} Writer;
+
+// Open a writer on a file (truncated), or on stdout for NULL / "-".
+Writer*     Open_Writer     (const char *path);
+// Open a writer on a descriptor left open by the writer (a socket).
+Writer*     Attach_Writer   (int fd);
+// Create a writer keeping its output in memory.
+Writer*     Create_Writer   (void);
+
+// Append bytes.
+void        Put_Bytes       (Writer *w, const char *data, size_t len);
+// Append a NUL terminated string.
+void        Put_Str         (Writer *w, const char *str);
+// Append a single character.
+void        Put_Char        (Writer *w, char c);
+// Append a decimal integer.
+void        Put_Int         (Writer *w, long value);
+// Append printf formatted text.
+void        Put_Format      (Writer *w, const char *fmt, ...);
+
+// Empty the buffer of a memory writer (or drop the pending bytes).
+void        Reset_Writer    (Writer *w);
+// Hand the pending bytes to the file.
+bool        Flush_Writer    (Writer *w);
+// Flush, close and free a writer, true if every byte was written.
+bool        Close_Writer    (Writer *w);
+
+#endif /* _WRITER_H_ */
@@ -0,0 +1,135 @@
+#include "../include/arena.h"
+
+/**
+ * @brief Allocate a new chunk and push it in front of the arena.
+ *
+ * @param arena The arena.
+ * @param size  The minimum number of bytes the chunk must hold.
+ * @return The new chunk, or NULL if the allocation failed.
+ */
+static ArenaChunk* Push_Chunk(Arena *arena, size_t size) {
+    size_t bytes = size + ARENA_ALIGN > arena->chunk ? size + ARENA_ALIGN : arena->chunk;
+    ArenaChunk *chunk = (ArenaChunk*)malloc(sizeof(ArenaChunk) + bytes);
+
+    if (!chunk) {
+        fprintf(stderr, "Memory ARENA allocation failed...");
+        return NULL;
+    }
+
+    Add_Stats(COUNT_ALLOCS, 1);
+    chunk->next = arena->head;
+    chunk->size = bytes;
+    chunk->used = 0;
+    arena->head = chunk;
+    return chunk;
+}
+
+/**
+ * @brief Create an arena growing by chunks of (at least) the given size.
+ *
+ * @param chunk The default chunk size, 0 for ARENA_CHUNK.
+ * @return A pointer to the created arena, or NULL if allocation fails.
+ */
+Arena* Create_Arena(size_t chunk) {
+    Arena *arena = (Arena*)malloc(sizeof(Arena));
+
+    if (!arena) {
+        fprintf(stderr, "Memory ARENA allocation failed...");
+        return NULL;
+    }
+
+    // Chunks are only allocated on the first request.
+    arena->head = NULL;
+    arena->chunk = chunk ? chunk : ARENA_CHUNK;
+    return arena;
+}
+
+/**
+ * @brief Allocate aligned memory from the arena, bumping the current chunk
+ * and starting a new one when it is full.
+ *
+ * @param arena The arena.
+ * @param size  The number of bytes.
+ * @return A pointer to the memory, or NULL if the allocation failed.
+ */
+void* Alloc_Arena(Arena *arena, size_t size) {
+    if (!arena) return NULL;
+
+    ArenaChunk *chunk = arena->head;
+
+    if (chunk) {
+        // Align the address, not just the offset, of the next object.
+        uintptr_t addr = (uintptr_t)(chunk->data + chunk->used);
+        size_t pad = (size_t)(-addr & (ARENA_ALIGN - 1));
+
+        if (chunk->used + pad + size <= chunk->size) {
+            chunk->used += pad;
+            void *mem = chunk->data + chunk->used;
+            chunk->used += size;
+            return mem;
+        }
+    }
+
+    chunk = Push_Chunk(arena, size);
+    if (!chunk) return NULL;
+
+    size_t pad = (size_t)(-(uintptr_t)chunk->data & (ARENA_ALIGN - 1));
+    chunk->used = pad + size;
+    return chunk->data + pad;
+}
+
+/**
+ * @brief Copy a string of a given length into the arena.
+ *
+ * @param arena The arena.
+ * @param str   The string (not necessarily NUL terminated).
+ * @param len   The number of characters to copy.
+ * @return The NUL terminated copy, or NULL if the allocation failed.
+ */
+char* Strndup_Arena(Arena *arena, const char *str, size_t len) {
+    char *copy = (char*)Alloc_Arena(arena, len + 1);
+    if (!copy) return NULL;
+
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+/**
+ * @brief Release everything allocated from the arena at once.
+ * The most recent chunk is kept (emptied), so an arena reset after every
+ * query stops allocating once it has grown to the size of one query.
+ *
+ * @param arena The arena.
+ */
+void Reset_Arena(Arena *arena) {
+    if (!arena || !arena->head) return;
+
+    ArenaChunk *chunk = arena->head->next;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    arena->head->next = NULL;
+    arena->head->used = 0;
+}
+
+/**
+ * @brief Free the arena and everything allocated from it.
+ *
+ * @param arena The arena to be freed.
+ */
+void Free_Arena(Arena *arena) {
+    if (!arena) return;
+
+    ArenaChunk *chunk = arena->head;
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(arena);
+}
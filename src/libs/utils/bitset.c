@@ -0,0 +1,196 @@
+#include "../include/bitset.h"
+
+/**
+ * @brief Create an empty set over the indices [0, n).
+ * 
+ * @param n The universe size.
+ * @return A pointer to the created set, or NULL on failure.
+ */
+BitSet* Create_BitSet(int n) {
+    BitSet *set = (BitSet*)malloc(sizeof(BitSet));
+    if (!set) return NULL;
+
+    set->n = n;
+    set->words = (n + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    set->cap = set->words ? set->words : 1;
+    set->bits = (uint64_t*)calloc(set->cap, sizeof(uint64_t));
+
+    if (!set->bits) {
+        fprintf(stderr, "Memory BITSET allocation failed...");
+        free(set);
+        return NULL;
+    }
+
+    Add_Stats(COUNT_ALLOCS, 1);
+
+    return set;
+}
+
+/**
+ * @brief Create a copy of a set.
+ * 
+ * @param set The set to copy.
+ * @return A pointer to the copy, or NULL on failure.
+ */
+BitSet* Copy_BitSet(BitSet *set) {
+    if (!set) return NULL;
+
+    BitSet *copy = Create_BitSet(set->n);
+    if (!copy) return NULL;
+
+    memcpy(copy->bits, set->bits, set->words * sizeof(uint64_t));
+    return copy;
+}
+
+/**
+ * @brief Free the memory occupied by a set.
+ * 
+ * @param set The set to free.
+ */
+void Free_BitSet(BitSet *set) {
+    if (!set) return;
+    free(set->bits);
+    free(set);
+}
+
+/**
+ * @brief Grow the universe of a set to [0, n), the new indices start out absent.
+ * The words are reallocated geometrically, so appending one index at a time
+ * costs amortized O(1).
+ * 
+ * @param set The set to grow.
+ * @param n   The new universe size (not smaller than the current one).
+ * @return true on success, false if the allocation failed.
+ */
+bool Grow_BitSet(BitSet *set, int n) {
+    if (!set || n < set->n) return false;
+
+    int words = (n + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    if (words > set->words) {
+        if (words > set->cap) {
+            int cap = 2 * set->cap;
+            while (cap < words) cap <<= 1;
+            uint64_t *bits = (uint64_t*)realloc(set->bits, cap * sizeof(uint64_t));
+            if (!bits) return false;
+            set->bits = bits;
+            set->cap = cap;
+        }
+        memset(&set->bits[set->words], 0, (words - set->words) * sizeof(uint64_t));
+        set->words = words;
+    }
+
+    set->n = n;
+    return true;
+}
+
+/**
+ * @brief Add an index to the set.
+ * 
+ * @param set The set.
+ * @param idx The index to add.
+ */
+void Set_Bit(BitSet *set, int idx) {
+    set->bits[idx / BITS_PER_WORD] |= (uint64_t)1 << (idx % BITS_PER_WORD);
+}
+
+/**
+ * @brief Remove an index from the set.
+ * 
+ * @param set The set.
+ * @param idx The index to remove.
+ */
+void Clear_Bit(BitSet *set, int idx) {
+    set->bits[idx / BITS_PER_WORD] &= ~((uint64_t)1 << (idx % BITS_PER_WORD));
+}
+
+/**
+ * @brief Check if an index is in the set.
+ * 
+ * @param set The set.
+ * @param idx The index to check.
+ * @return true if the index is in the set, false otherwise.
+ */
+bool Test_Bit(BitSet *set, int idx) {
+    return (set->bits[idx / BITS_PER_WORD] >> (idx % BITS_PER_WORD)) & 1;
+}
+
+/**
+ * @brief Union of two sets over the same universe, stored in dst.
+ * 
+ * @param dst The set receiving the result.
+ * @param src The set to add.
+ */
+void Union_BitSet(BitSet *dst, BitSet *src) {
+    for (int w = 0; w < dst->words; w++)
+        dst->bits[w] |= src->bits[w];
+}
+
+/**
+ * @brief Difference of two sets over the same universe, stored in dst.
+ * 
+ * @param dst The set receiving the result.
+ * @param src The set to remove.
+ */
+void AndNot_BitSet(BitSet *dst, BitSet *src) {
+    for (int w = 0; w < dst->words; w++)
+        dst->bits[w] &= ~src->bits[w];
+}
+
+/**
+ * @brief Remove every index from a set, keeping its memory.
+ * 
+ * @param set The set to clear.
+ */
+void Clear_BitSet(BitSet *set) {
+    memset(set->bits, 0, set->words * sizeof(uint64_t));
+}
+
+/**
+ * @brief Complement a set, keeping the bits past n clear.
+ * 
+ * @param set The set to complement.
+ */
+void Complement_BitSet(BitSet *set) {
+    for (int w = 0; w < set->words; w++)
+        set->bits[w] = ~set->bits[w];
+
+    // Mask out the unused tail of the last word.
+    if (set->n % BITS_PER_WORD)
+        set->bits[set->words - 1] &= ((uint64_t)1 << (set->n % BITS_PER_WORD)) - 1;
+}
+
+/**
+ * @brief Count the indices in a set.
+ * 
+ * @param set The set.
+ * @return The number of indices in the set.
+ */
+int Count_BitSet(BitSet *set) {
+    int count = 0;
+    for (int w = 0; w < set->words; w++)
+        count += __builtin_popcountll(set->bits[w]);
+    return count;
+}
+
+/**
+ * @brief Find the smallest index >= from in the set.
+ * 
+ * @param set  The set.
+ * @param from The index to start from.
+ * @return The found index, or -1 if there is none.
+ */
+int Next_Bit(BitSet *set, int from) {
+    if (from >= set->n) return -1;
+
+    int w = from / BITS_PER_WORD;
+    // Drop the bits below from in the first word.
+    uint64_t word = set->bits[w] & (~(uint64_t)0 << (from % BITS_PER_WORD));
+
+    while (!word) {
+        if (++w >= set->words) return -1;
+        word = set->bits[w];
+    }
+
+    return w * BITS_PER_WORD + __builtin_ctzll(word);
+}
@@ -1,7 +1,48 @@
 #include "../include/graph.h"
+#include "../include/snapshot.h"
 
 /* ----------------------------------------------------------------------------------- */
 
+/**
+ * @brief Check if an array is a view into a buffer (not owned).
+ * 
+ * @param arr    The array.
+ * @param buffer The start of the buffer.
+ * @param len    The length of the buffer.
+ * @return true if it lies inside the buffer.
+ */
+static inline bool Is_View(const void *arr, char *buffer, size_t len) {
+    return buffer && (const char*)arr >= buffer && (const char*)arr < buffer + len;
+}
+
+/**
+ * @brief Free an array of the graph, unless it is borrowed from the mapping.
+ * 
+ * @param g   The graph.
+ * @param arr The array.
+ */
+static void Free_Array(Graph *g, void *arr) {
+    if (!Is_View(arr, g->map, g->mapLen)) free(arr);
+}
+
+/**
+ * @brief Grow an array of the graph, an array borrowed from the mapping is
+ * copied out instead of reallocated.
+ * 
+ * @param g    The graph.
+ * @param arr  The array.
+ * @param used The bytes in use.
+ * @param size The new size in bytes.
+ * @return The grown array, or NULL if the allocation failed (arr is kept).
+ */
+static void* Grow_Array(Graph *g, void *arr, size_t used, size_t size) {
+    if (!Is_View(arr, g->map, g->mapLen)) return realloc(arr, size);
+
+    void *copy = malloc(size);
+    if (copy) memcpy(copy, arr, used);
+    return copy;
+}
+
 /**
  * @brief Get the name of a node in the graph by its index.
  * 
@@ -23,155 +64,486 @@ char* Get_ValNode(Graph *g, int v) {
  * @return The index of the node.
  */
 int Get_IdxNode(Graph *g, char *name) {
-    if (!g || !g->idxMap || !name) return -1;
-    // Iterate through the vertexes until we found the index node.
-    for (int v = 0; v < g->V; v++)
-        if (!strcmp(g->idxMap[v], name))
-            return v;
-    return -1;
+    if (!g || !g->idxHash || !name) return -1;
+    Add_Stats(COUNT_LOOKUPS, 1);
+    // Look the name up in the symbol table.
+    return Get_HashMap(g->idxHash, name, strlen(name));
+}
+
+/**
+ * @brief Get the index of a node in the graph by a token that is not
+ * NUL terminated (a view into the input mapping).
+ * 
+ * @param g    The graph.
+ * @param name The start of the token.
+ * @param len  The length of the token.
+ * @return The index of the node, or -1 if not found.
+ */
+int Get_IdxToken(Graph *g, const char *name, size_t len) {
+    if (!g || !g->idxHash || !name) return -1;
+    return Get_HashMap(g->idxHash, name, len);
 }
 
 /**
  * @brief Add an edge between two nodes in the graph.
+ * The edge is only recorded in the buffer, the CSR is built by Create_CSR.
+ * If the buffer cannot grow, it is marked failed and the edge is dropped.
  * 
- * @param g  The graph.
- * @param V1 The name of the first node.
- * @param V2 The name of the second node.
+ * @param edges The buffer collecting the edges.
+ * @param v1    The index of the first node.
+ * @param v2    The index of the second node.
  */
-void Add_Edge(Graph *g, char *V1, char *V2) {
-    if (!g || !g->adjList || !g->idxMap || !V1 || !V2) return;
-
-    // Get the index of the first node (V1).
-    int v1 = Get_IdxNode(g, V1);
-    if (v1 == -1) return; // Not found.
-
-    // Create a new graph node for the second node (V2)
-    GraphNode *v2 = (GraphNode*)malloc(sizeof(GraphNode));
-    if (!v2) return;
-
-    // Duplicate the name of the second node.
-    // Ensure it's not modified externally.
-    v2->name = strdup(V2);
-    if (!v2->name) {
-        free(v2);
-        return;
+void Add_Edge(EdgeBuf *edges, int v1, int v2) {
+    // Skip edges to unknown nodes.
+    if (!edges || v1 == -1 || v2 == -1) return;
+
+    // Grow the buffer geometrically when it is full.
+    if (edges->len == edges->cap) {
+        int cap = edges->cap ? 2 * edges->cap : 64;
+        int *src = (int*)realloc(edges->src, cap * sizeof(int));
+        if (src) edges->src = src;
+        int *dst = (int*)realloc(edges->dst, cap * sizeof(int));
+        if (dst) edges->dst = dst;
+        if (!src || !dst) {
+            edges->failed = true;
+            return;
+        }
+        edges->dst = dst;
+        edges->cap = cap;
     }
 
-    // Add the new node (V2) to the adjacency list of the first node (V1).
-    v2->next = g->adjList[v1];
-    g->adjList[v1] = v2;
+    edges->src[edges->len] = v1;
+    edges->dst[edges->len] = v2;
+    edges->len++;
 }
 
-/* ----------------------------------------------------------------------------------- */
+/**
+ * @brief Compact the collected edges into the CSR adjacency of the graph.
+ * The edges may come in several buffers (one per parsed chunk), taken in
+ * order. Counting sort by source keeps the edges of a vertex in insertion
+ * order, so the adjacency doesn't depend on how the input was split.
+ * 
+ * @param g     The graph.
+ * @param parts The buffers with the collected edges.
+ * @param count The number of buffers.
+ * @return true on success, false if the allocation failed.
+ */
+bool Create_CSR(Graph *g, EdgeBuf *parts, int count) {
+    if (!g || !g->adjList.offset || !parts) return false;
+    uint64_t start = Start_Stats();
+
+    long total = 0;
+    for (int p = 0; p < count; p++)
+        total += parts[p].len;
+
+    int *adj = total <= INT32_MAX ? (int*)malloc((total ? total : 1) * sizeof(int)) : NULL;
+    if (!adj) {
+        fprintf(stderr, "Memory ADJ allocation failed...");
+        return false;
+    }
 
+    // Count the out-degree of every vertex, then prefix sum into offsets.
+    int *offset = g->adjList.offset;
+    memset(offset, 0, (g->V + 1) * sizeof(int));
+    for (int p = 0; p < count; p++) {
+        for (int e = 0; e < parts[p].len; e++)
+            offset[parts[p].src[e] + 1]++;
+    }
+    for (int u = 0; u < g->V; u++)
+        offset[u + 1] += offset[u];
+
+    // Scatter the destinations into their rows.
+    int *fill = (int*)malloc((g->V ? g->V : 1) * sizeof(int));
+    if (!fill) {
+        fprintf(stderr, "Memory FILL allocation failed...");
+        free(adj);
+        return false;
+    }
+    memcpy(fill, offset, g->V * sizeof(int));
+    for (int p = 0; p < count; p++) {
+        for (int e = 0; e < parts[p].len; e++)
+            adj[fill[parts[p].src[e]]++] = parts[p].dst[e];
+    }
+    free(fill);
+
+    Free_Array(g, g->adjList.adj);
+    g->adjList.adj = adj;
+    g->E = (int)total;
+    g->capE = total ? (int)total : 1;
+    Stop_Stats(PHASE_CSR, start);
+    return true;
+}
 
 /**
- * @brief Create a graph based on data from a file.
+ * @brief Transpose a CSR adjacency into preallocated arrays.
+ * One counting pass over the edges gives the in-degrees, their prefix sums
+ * give the row offsets, and a second pass scatters the reversed edges.
  * 
- * @return A pointer to the created graph.
+ * @param V       The number of vertices.
+ * @param offset  The forward offsets (V + 1 ints).
+ * @param adj     The forward neighbors.
+ * @param offsetT The transposed offsets (V + 1 ints, zeroed).
+ * @param adjT    The transposed neighbors (E ints).
+ * @param fill    Scratch of V ints.
  */
-Graph* Create_Graph(void) {
-    FILE *fin = fopen("blockdag.in", "r");
- 
-    if (!fin) {
-        fprintf(stderr, "Couldn't open file for reading");
-        exit(EXIT_FAILURE);
+static void Transpose_CSR(int V, const int *offset, const int *adj,
+                          int *offsetT, int *adjT, int *fill) {
+    // In-degree of every vertex, then prefix sum into offsets.
+    for (int e = 0; e < offset[V]; e++)
+        offsetT[adj[e] + 1]++;
+    for (int u = 0; u < V; u++)
+        offsetT[u + 1] += offsetT[u];
+
+    // Reverse every edge (u -> v) into the row of v.
+    memcpy(fill, offsetT, V * sizeof(int));
+    for (int u = 0; u < V; u++) {
+        for (int e = offset[u]; e < offset[u + 1]; e++) {
+            adjT[fill[adj[e]]++] = u;
+        }
     }
+}
 
-    size_t len = 0;
-    char *line = NULL;
+/**
+ * @brief Build the transposed CSR adjacency from the forward one.
+ * 
+ * @param g The graph, with its forward CSR already built.
+ * @return true on success, false if the allocation failed.
+ */
+bool Create_TCSR(Graph *g) {
+    if (!g || !g->adjList.offset) return false;
+    uint64_t start = Start_Stats();
+
+    int *offset = (int*)calloc(g->V + 1, sizeof(int));
+    int *adj = (int*)malloc((g->E ? g->E : 1) * sizeof(int));
+    int *fill = (int*)malloc((g->V ? g->V : 1) * sizeof(int));
+
+    if (!offset || !adj || !fill) {
+        fprintf(stderr, "Memory ADJLISTT allocation failed...");
+        free(offset);
+        free(adj);
+        free(fill);
+        return false;
+    }
 
-    // Read the first line to determine the number of vertices (V).
-    if (getline(&line, &len, fin) == -1)
-        fprintf(stderr, "LINE READ");
+    Transpose_CSR(g->V, g->adjList.offset, g->adjList.adj, offset, adj, fill);
+    free(fill);
 
-    int V = atoi(line);
+    Free_Array(g, g->adjListT.offset);
+    Free_Array(g, g->adjListT.adj);
+    g->adjListT.offset = offset;
+    g->adjListT.adj = adj;
+    g->staleT = false;
+    Stop_Stats(PHASE_TCSR, start);
+    return true;
+}
 
-    // Read the second line containing vertex names.
-    if (getline(&line, &len, fin) == -1)
-        fprintf(stderr, "LINE READ");
+/**
+ * @brief Rebuild the transposed CSR adjacency if blocks were appended since.
+ * 
+ * @param g The graph.
+ * @return true if the transposed adjacency is up to date, false on failure.
+ */
+bool Refresh_TCSR(Graph *g) {
+    if (!g) return false;
+    return !g->staleT || Create_TCSR(g);
+}
 
-    // Create an adjacency list,
-    // representation of the graph using the provided data.
-    Graph *g = Create_AdjList(V, line);
+/**
+ * @brief Build the tips set from the transposed adjacency (empty rows).
+ * 
+ * @param g The graph, with its transposed CSR already built.
+ * @return true on success, false if the allocation failed.
+ */
+bool Create_Tips(Graph *g) {
+    Free_BitSet(g->tips);
+    g->tips = Create_BitSet(g->V);
+    if (!g->tips) return false;
 
-    if (!g) {
-        fclose(fin);
-        free(line);
-        return NULL;
+    for (int u = 0; u < g->V; u++) {
+        if (g->adjListT.offset[u] == g->adjListT.offset[u + 1])
+            Set_Bit(g->tips, u);
     }
 
-    // Read and process the remaining lines to add edges between vertices.
-    if (getline(&line, &len, fin) == -1)
-        fprintf(stderr, "LINE READ");
+    return true;
+}
+
+/**
+ * @brief Free the memory occupied by an edge buffer.
+ * 
+ * @param edges The edge buffer to be freed.
+ */
+void Free_EdgeBuf(EdgeBuf *edges) {
+    if (!edges) return;
+    free(edges->src);
+    free(edges->dst);
+    edges->src = edges->dst = NULL;
+    edges->len = edges->cap = 0;
+    edges->failed = false;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
 
-    while (getline(&line, &len, fin) != -1) {
-        char *V1 = strtok(line, DELIM_OPER), *V2 = NULL;
-        // Add an edge between vertices V1 and V2 in the graph.
-        while ((V2 = strtok(NULL, DELIM_OPER))) {
-            Add_Edge(g, V1, V2);
+/**
+ * @brief Check if a character separates the tokens of a line.
+ * 
+ * @param c The character.
+ * @return true if c is one of DELIM_OPER.
+ */
+static inline bool Is_Delim(char c) {
+    return c == ' ' || c == ':' || c == '\n';
+}
+
+/**
+ * @brief Find the next token of a line, without writing into it.
+ * 
+ * @param pos In: where to start scanning, out: just past the token.
+ * @param end The end of the line.
+ * @param len Out: the length of the token.
+ * @return The start of the token, or NULL if the line has no more tokens.
+ */
+static char* Next_Token(char **pos, char *end, size_t *len) {
+    char *p = *pos;
+    while (p < end && Is_Delim(*p)) p++;
+    if (p == end) return NULL;
+
+    char *tok = p;
+    while (p < end && !Is_Delim(*p)) p++;
+    *len = (size_t)(p - tok);
+    *pos = p;
+    return tok;
+}
+
+/**
+ * @brief Find the end of the line starting at pos (its newline, or the end
+ * of the mapping when the last line has none).
+ * 
+ * @param pos The start of the line.
+ * @param end The end of the mapping.
+ * @return A pointer to the newline ending the line, or end.
+ */
+static char* Line_End(char *pos, char *end) {
+    char *nl = memchr(pos, '\n', (size_t)(end - pos));
+    return nl ? nl : end;
+}
+
+/**
+ * @brief Parse the "Node : parents" lines of [pos, end) into an edge buffer.
+ * Only reads the mapping and the symbol table, so chunks of the edge
+ * section can be parsed by several threads at once.
+ * 
+ * @param g     The graph, its symbol table complete.
+ * @param pos   The start of the first line.
+ * @param end   The end of the last line.
+ * @param edges The buffer collecting the edges.
+ */
+static void Parse_Edges(Graph *g, char *pos, char *end, EdgeBuf *edges) {
+    uint64_t lookups = 0;
+
+    while (pos < end) {
+        char *eol = Line_End(pos, end);
+
+        size_t len1 = 0, len2 = 0;
+        char *V1 = Next_Token(&pos, eol, &len1), *V2 = NULL;
+
+        if (V1) {
+            int v1 = Get_IdxToken(g, V1, len1);
+            lookups++;
+            // Add an edge between vertices V1 and V2 in the graph.
+            while ((V2 = Next_Token(&pos, eol, &len2))) {
+                Add_Edge(edges, v1, Get_IdxToken(g, V2, len2));
+                lookups++;
+            }
         }
+
+        pos = eol < end ? eol + 1 : end;
     }
 
-    fclose(fin);
-    free(line);
-    return g;
+    Add_Stats(COUNT_LOOKUPS, lookups);
 }
 
+// Shared state of a chunked parse of the edge section, one chunk per pool item.
+typedef struct ParseJob {
+    Graph *g;               // The graph, its symbol table complete (read only).
+    char **cuts;            // Chunk c is [cuts[c], cuts[c + 1]), cut at line starts.
+    EdgeBuf *parts;         // Edges of every chunk.
+} ParseJob;
+
 /**
- * @brief Create a transpose graph of the given graph.
+ * @brief Parse one chunk of the edge section into its own buffer.
  * 
- * @param g The original graph.
- * @return A pointer to the transpose graph.
+ * @param ctx    The parse (ParseJob).
+ * @param worker The worker parsing the chunk (unused).
+ * @param item   The chunk.
  */
-Graph* Create_TGraph(Graph *g) {
-    if (!g || !g->adjList || !g->idxMap) return NULL;
+static void Parse_Chunk(void *ctx, int worker, int item) {
+    ParseJob *job = (ParseJob*)ctx;
+    Parse_Edges(job->g, job->cuts[item], job->cuts[item + 1], &job->parts[item]);
+}
 
-    FILE *fin = fopen("blockdag.in", "r");
+/**
+ * @brief Collect the edges of the "Node : parents" section into the CSR.
+ * With a pool, the section is cut into chunks at line boundaries, parsed in
+ * parallel into per-chunk buffers, then merged in input order by Create_CSR.
+ * 
+ * @param g    The graph, its symbol table complete.
+ * @param pool The workers (NULL to parse on the calling thread).
+ * @param pos  The start of the edge section.
+ * @param end  The end of the mapping.
+ * @return true on success, false if an allocation failed.
+ */
+static bool Load_Edges(Graph *g, Pool *pool, char *pos, char *end) {
+    uint64_t parse = Start_Stats();
+    size_t size = (size_t)(end - pos);
+    int chunks = pool ? pool->size * LOAD_SPLIT : 1;
+
+    // Small inputs don't pay for the split.
+    if ((size_t)chunks * LOAD_CHUNK > size)
+        chunks = size / LOAD_CHUNK > 1 ? (int)(size / LOAD_CHUNK) : 1;
+
+    char **cuts = (char**)malloc((chunks + 1) * sizeof(char*));
+    EdgeBuf *parts = (EdgeBuf*)calloc(chunks, sizeof(EdgeBuf));
+
+    if (!cuts || !parts) {
+        fprintf(stderr, "Memory EDGES allocation failed...");
+        free(cuts);
+        free(parts);
+        return false;
+    }
+
+    // Cut after the newline at or past every even split.
+    cuts[0] = pos;
+    for (int c = 1; c < chunks; c++) {
+        char *cut = pos + size / chunks * c;
+        if (cut < cuts[c - 1]) cut = cuts[c - 1];
+        cut = Line_End(cut, end);
+        cuts[c] = cut < end ? cut + 1 : end;
+    }
+    cuts[chunks] = end;
+
+    ParseJob job = { g, cuts, parts };
+    Run_Pool(chunks > 1 ? pool : NULL, chunks, Parse_Chunk, &job);
+    Stop_Stats(PHASE_EDGES, parse);
+
+    // A dropped edge would load a wrong graph.
+    bool built = true;
+    for (int c = 0; c < chunks; c++)
+        built = built && !parts[c].failed;
+    if (!built) fprintf(stderr, "Memory EDGES allocation failed...");
+
+    // Compact the edges into the CSR adjacency.
+    built = built && Create_CSR(g, parts, chunks);
+
+    for (int c = 0; c < chunks; c++)
+        Free_EdgeBuf(&parts[c]);
+    free(parts);
+    free(cuts);
+    return built;
+}
 
-    if (!fin) {
+/**
+ * @brief Create a graph based on data from a file.
+ * The file is mapped privately and tokenized in place: the names are views
+ * into the mapping (terminated by overwriting the delimiter after them, which
+ * only dirties the pages of the names line), and the edge tokens are looked
+ * up by (pointer, length) without any copy or allocation per token. Once the
+ * names are interned, the edge lines are independent: with a pool they are
+ * parsed in parallel chunks.
+ * 
+ * @param pool The workers parsing the edge lines (NULL for the calling thread).
+ * @return A pointer to the created graph.
+ */
+Graph* Create_Graph(Pool *pool) {
+    uint64_t start = Start_Stats();
+    int fd = open("blockdag.in", O_RDONLY);
+ 
+    if (fd == -1) {
         fprintf(stderr, "Couldn't open file for reading");
         exit(EXIT_FAILURE);
     }
 
-    size_t len = 0;
-    char *line = NULL;
-
-    // Read the first two lines from the file,
-    // which are not used in this function.
-    if (getline(&line, &len, fin) == -1) 
-        fprintf(stderr, "LINE READ");
-    if (getline(&line, &len, fin) == -1)
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
         fprintf(stderr, "LINE READ");
+        close(fd);
+        return NULL;
+    }
 
-    fclose(fin);
+    size_t size = (size_t)st.st_size;
+    char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
 
-    // Create an adjacency list representation of the transpose graph.
-    Graph *graphT = Create_AdjList(g->V, line);
-    if (!graphT) return NULL;
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Couldn't map file for reading");
+        return NULL;
+    }
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+    Add_Stats(COUNT_READ, size);
+
+    // A binary snapshot is loaded straight from the mapping.
+    if (Is_Snapshot(map, size)) {
+        Graph *g = Load_Snapshot(map, size);
+        if (!g) munmap(map, size);
+        Stop_Stats(PHASE_LOAD, start);
+        return g;
+    }
 
-    // Iterate through the vertices of the original graph
-    // and reverse edges in the transpose graph.
-    for (int u = 0; u < g->V; u++) {
-        GraphNode* v = g->adjList[u];
-        while (v) {
-            Add_Edge(graphT, v->name, Get_ValNode(g, u));
-            v = v->next;
-        }
+    char *end = map + size;
+    char *pos = map, *eol = Line_End(pos, end);
+
+    // The first line holds the number of vertices (V).
+    char count[32] = { 0 };
+    size_t digits = (size_t)(eol - pos) < sizeof(count) - 1 ?
+                    (size_t)(eol - pos) : sizeof(count) - 1;
+    memcpy(count, pos, digits);
+    int V = atoi(count);
+
+    // The second line holds the vertex names, the newline stays in the line.
+    pos = eol < end ? eol + 1 : end;
+    eol = Line_End(pos, end);
+    size_t len = (size_t)(eol - pos) + (eol < end);
+
+    // Create an adjacency list,
+    // representation of the graph using the provided data.
+    uint64_t names = Start_Stats();
+    Graph *g = Create_AdjList(V, pos, len);
+    Stop_Stats(PHASE_IDXMAP, names);
+    Add_Stats(COUNT_LOOKUPS, V);
+
+    if (!g) {
+        munmap(map, size);
+        return NULL;
+    }
+    g->map = map;
+    g->mapLen = size;
+
+    // Skip the third line, then process the remaining lines
+    // to add edges between vertices.
+    pos = eol < end ? eol + 1 : end;
+    eol = Line_End(pos, end);
+    pos = eol < end ? eol + 1 : end;
+
+    // Build the CSR adjacency from the edge lines, and its transpose.
+    bool built = Load_Edges(g, pool, pos, end) && Create_TCSR(g) && Create_Tips(g);
+
+    if (!built) {
+        Free_Graph(g);
+        return NULL;
     }
 
-    free(line);
-    return graphT;
+    Stop_Stats(PHASE_LOAD, start);
+    return g;
 }
 
 /**
  * @brief Create an adjacency list representation of a graph.
  * 
  * @param V      The number of vertices in the graph.
- * @param buffer A buffer containing vertex names.
+ * @param buffer A buffer containing vertex names, tokenized in place.
+ * @param len    The length of the buffer.
  * @return A pointer to the created graph.
  */
-Graph* Create_AdjList(int V, char *buffer) {
+Graph* Create_AdjList(int V, char *buffer, size_t len) {
     Graph *g = (Graph*)malloc(sizeof(Graph));
 
     if (!g) {
@@ -179,22 +551,56 @@ Graph* Create_AdjList(int V, char *buffer) {
         return NULL;
     }
 
-    // Set the number of vertices in the graph.
+    // Set the number of vertices in the graph, no edges yet.
     g->V = V;
+    g->E = 0;
+    // The arenas hold the names that are not views, and the query memory.
+    g->arena = Create_Arena(0);
+    g->scratch = Create_Arena(0);
     // Create an index map for vertex names using the provided buffer.
-    g->idxMap = Create_IdxMap(V, buffer);
+    g->idxMap = g->arena && g->scratch ? Create_IdxMap(V, buffer, len, g->arena) : NULL;
 
     if (!g->idxMap) {
+        Free_Arena(g->arena);
+        Free_Arena(g->scratch);
         free(g);
         return NULL;
     }
 
-    // Allocate memory for the adjacency list (array of linked lists).
-    g->adjList = (GraphNode**)calloc(V, sizeof(GraphNode*));
+    // Build the symbol table alongside the index map.
+    g->idxHash = Create_HashMap(V);
+
+    if (g->idxHash) {
+        for (int u = 0; u < V; u++) {
+            Put_HashMap(g->idxHash, g->idxMap[u], u);
+        }
+    }
 
-    if (!g->adjList) {
+    // Allocate memory for the CSR offsets, every row starts out empty.
+    g->adjList.offset = (int*)calloc(V + 1, sizeof(int));
+    g->adjList.adj = NULL;
+    g->adjListT.offset = NULL;
+    g->adjListT.adj = NULL;
+    g->capV = V ? V : 1;
+    g->capE = 1;
+    g->tips = NULL;
+    g->staleT = false;
+    g->map = NULL;
+    g->mapLen = 0;
+    g->rank = NULL;
+    g->byRank = NULL;
+    g->nameLen = NULL;
+    g->ranked = 0;
+    g->prunedPast = NULL;
+    g->pruned = 0;
+
+    if (!g->idxHash || !g->adjList.offset) {
         fprintf(stderr, "Memory ADJLIST allocation failed...");
+        Free_HashMap(g->idxHash);
+        free(g->adjList.offset);
         free(g->idxMap);
+        Free_Arena(g->arena);
+        Free_Arena(g->scratch);
         free(g);
         return NULL;
     }
@@ -206,39 +612,243 @@ Graph* Create_AdjList(int V, char *buffer) {
 /* ----------------------------------------------------------------------------------- */
 
 /**
- * @brief Free the memory allocated for a graph.
+ * @brief Make room for one more vertex and count more edges, growing the
+ * arrays geometrically (amortized O(1) per appended block and edge).
  * 
- * @param g The graph to be freed.
+ * @param g     The graph.
+ * @param count The number of edges the new vertex brings.
+ * @return true on success, false if the allocation failed.
  */
-void Free_Graph(Graph *g) {
-    if (!g) return;
-
-    if (g->adjList) {
-        // Iterate through each vertex in the adjacency list.
-        for (int u = 0; u < g->V; u++) {
-            GraphNode *v = g->adjList[u];
-
-            while (v) {
-                GraphNode *del = v;
-                v = v->next;
-                // Free the memory allocated for
-                //  the name of the node and node itself.
-                free(del->name);
-                free(del);
-            }
+static bool Reserve_Block(Graph *g, int count) {
+    if (g->V + 1 > g->capV) {
+        int cap = g->capV ? 2 * g->capV : 1;
+        char **idxMap = (char**)realloc(g->idxMap, cap * sizeof(char*));
+        if (!idxMap) return false;
+        g->idxMap = idxMap;
+        int *offset = (int*)Grow_Array(g, g->adjList.offset,
+                                       (g->V + 1) * sizeof(int), (cap + 1) * sizeof(int));
+        if (!offset) return false;
+        g->adjList.offset = offset;
+        if (g->prunedPast) {
+            int *prunedPast = (int*)realloc(g->prunedPast, cap * sizeof(int));
+            if (!prunedPast) return false;
+            g->prunedPast = prunedPast;
         }
-        free(g->adjList);
+        g->capV = cap;
     }
 
-    if (g->idxMap) {
-        // Iterate through each vertex in the index map
-        // and free the memory for vertex names.
-        for (int u = 0; u < g->V; u++) {
-            free(g->idxMap[u]);
+    if (g->E + count > g->capE) {
+        int cap = g->capE ? 2 * g->capE : 1;
+        while (cap < g->E + count) cap <<= 1;
+        int *adj = (int*)Grow_Array(g, g->adjList.adj, g->E * sizeof(int), cap * sizeof(int));
+        if (!adj) return false;
+        g->adjList.adj = adj;
+        g->capE = cap;
+    }
+
+    return Grow_BitSet(g->tips, g->V + 1);
+}
+
+/**
+ * @brief Append a new block, referencing existing parents, to the graph in place.
+ * The forward CSR grows at its end, the tips are updated incrementally (the
+ * block becomes a tip, its parents stop being tips) in O(count), and the
+ * transposed adjacency is marked stale until the next Refresh_TCSR. In a
+ * pruned graph, the block counts the pruned blocks of its fullest parent,
+ * which is exact as long as the pruning point is in its past.
+ * 
+ * @param g       The graph.
+ * @param name    The name of the new block.
+ * @param parents The names of its parents.
+ * @param count   The number of parents.
+ * @return The index of the new block, or -1 if rejected (duplicate name,
+ *         unknown parent) or on failure.
+ */
+int Append_Block(Graph *g, char *name, char **parents, int count) {
+    if (!g || !g->tips || !name || (count && !parents)) return -1;
+
+    // Reject duplicates and unknown parents before touching the graph.
+    if (Get_IdxNode(g, name) != -1) return -1;
+    for (int p = 0; p < count; p++) {
+        if (Get_IdxNode(g, parents[p]) == -1) return -1;
+    }
+
+    if (!Reserve_Block(g, count)) {
+        fprintf(stderr, "Memory APPEND allocation failed...");
+        return -1;
+    }
+
+    int v = g->V;
+    g->idxMap[v] = Strndup_Arena(g->arena, name, strlen(name));
+    if (!g->idxMap[v] || !Put_HashMap(g->idxHash, g->idxMap[v], v))
+        return -1;
+
+    // The row of the new block is the tail of the forward adjacency.
+    if (g->prunedPast) g->prunedPast[v] = 0;
+    for (int p = 0; p < count; p++) {
+        int u = Get_IdxNode(g, parents[p]);
+        g->adjList.adj[g->E++] = u;
+        Clear_Bit(g->tips, u);
+        if (g->prunedPast && g->prunedPast[u] > g->prunedPast[v])
+            g->prunedPast[v] = g->prunedPast[u];
+    }
+
+    g->V++;
+    g->adjList.offset[g->V] = g->E;
+    Set_Bit(g->tips, v);
+    g->staleT = true;
+
+    return v;
+}
+
+/**
+ * @brief Drop a set of vertices from the graph and compact what is left.
+ * The kept vertices are renumbered in their order, their names are copied
+ * into a fresh arena and the forward CSR is rebuilt without the dropped
+ * vertices, so the input mapping and the old arrays are released: memory
+ * follows the kept graph only. The transposed CSR and the tips are rebuilt
+ * before the swap and the ranks are dropped until the next Rank_Names, so
+ * nothing is changed if an allocation fails.
+ * 
+ * @param g    The graph.
+ * @param drop The vertices to drop, over [0, V).
+ * @return true on success, false on failure.
+ */
+bool Compact_Graph(Graph *g, BitSet *drop) {
+    if (!g || !drop || drop->n != g->V) return false;
+
+    int V = g->V, K = 0, E = 0;
+    int *renum = (int*)malloc((V ? V : 1) * sizeof(int));
+    if (!renum) return false;
+
+    // New index of every kept vertex, and the kept edges.
+    for (int u = 0; u < V; u++) {
+        renum[u] = Test_Bit(drop, u) ? -1 : K++;
+        if (renum[u] == -1) continue;
+        for (int e = g->adjList.offset[u]; e < g->adjList.offset[u + 1]; e++)
+            E += !Test_Bit(drop, g->adjList.adj[e]);
+    }
+
+    int cap = K ? K : 1;
+    char **idxMap = (char**)malloc(cap * sizeof(char*));
+    HashMap *idxHash = Create_HashMap(cap);
+    Arena *arena = Create_Arena(0);
+    int *offset = (int*)malloc((cap + 1) * sizeof(int));
+    int *adj = (int*)malloc((E ? E : 1) * sizeof(int));
+    int *prunedPast = g->prunedPast ? (int*)malloc(cap * sizeof(int)) : NULL;
+    int *offsetT = (int*)calloc(cap + 1, sizeof(int));
+    int *adjT = (int*)malloc((E ? E : 1) * sizeof(int));
+    BitSet *tips = Create_BitSet(K);
+    bool ok = idxMap && idxHash && arena && offset && adj && offsetT && adjT &&
+              tips && (prunedPast || !g->prunedPast);
+
+    // Copy the kept vertices out: names, rows and pruned counts.
+    // Every kept vertex is a tip until one of its kept children is seen.
+    if (ok) offset[0] = 0;
+    for (int u = 0, k = 0, f = 0; ok && u < V; u++) {
+        if (renum[u] == -1) continue;
+
+        idxMap[k] = Strndup_Arena(arena, g->idxMap[u], strlen(g->idxMap[u]));
+        ok = idxMap[k] && Put_HashMap(idxHash, idxMap[k], k);
+
+        Set_Bit(tips, k);
+        for (int e = g->adjList.offset[u]; e < g->adjList.offset[u + 1]; e++) {
+            if (renum[g->adjList.adj[e]] != -1) adj[f++] = renum[g->adjList.adj[e]];
         }
-        free(g->idxMap);
+        offset[++k] = f;
+
+        if (prunedPast) prunedPast[k - 1] = g->prunedPast[u];
+    }
+    for (int e = 0; ok && e < E; e++)
+        Clear_Bit(tips, adj[e]);
+
+    // The renumbering is no longer needed, its memory fills the transposition.
+    if (ok) Transpose_CSR(K, offset, adj, offsetT, adjT, renum);
+    free(renum);
+
+    if (!ok) {
+        fprintf(stderr, "Memory COMPACT allocation failed...");
+        free(idxMap);
+        Free_HashMap(idxHash);
+        Free_Arena(arena);
+        free(offset);
+        free(adj);
+        free(offsetT);
+        free(adjT);
+        free(prunedPast);
+        Free_BitSet(tips);
+        return false;
     }
 
+    // Release the old graph, borrowed arrays first (they live in the mapping).
+    Free_Array(g, g->adjList.offset);
+    Free_Array(g, g->adjList.adj);
+    Free_Array(g, g->adjListT.offset);
+    Free_Array(g, g->adjListT.adj);
+    Free_HashMap(g->idxHash);
+    free(g->idxMap);
+    Free_Arena(g->arena);
+    Free_BitSet(g->tips);
+    free(g->prunedPast);
+    free(g->rank);
+    free(g->byRank);
+    free(g->nameLen);
+    if (g->map) munmap(g->map, g->mapLen);
+
+    g->V = K;
+    g->E = E;
+    g->idxMap = idxMap;
+    g->idxHash = idxHash;
+    g->arena = arena;
+    g->adjList.offset = offset;
+    g->adjList.adj = adj;
+    g->adjListT.offset = offsetT;
+    g->adjListT.adj = adjT;
+    g->capV = cap;
+    g->capE = E ? E : 1;
+    g->tips = tips;
+    g->prunedPast = prunedPast;
+    g->rank = g->byRank = g->nameLen = NULL;
+    g->ranked = 0;
+    g->map = NULL;
+    g->mapLen = 0;
+    g->staleT = false;
+    return true;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+/**
+ * @brief Free the memory allocated for a graph.
+ * 
+ * @param g The graph to be freed.
+ */
+void Free_Graph(Graph *g) {
+    if (!g) return;
+
+    // The CSR arrays hold plain indices, no per-edge memory,
+    // and may be borrowed from a mapped snapshot.
+    Free_Array(g, g->adjList.offset);
+    Free_Array(g, g->adjList.adj);
+    Free_Array(g, g->adjListT.offset);
+    Free_Array(g, g->adjListT.adj);
+    Free_BitSet(g->tips);
+    free(g->rank);
+    free(g->byRank);
+    free(g->nameLen);
+    free(g->prunedPast);
+
+    // The symbol table borrows the names from the index map.
+    Free_HashMap(g->idxHash);
+
+    // The names are views into the mapping or live in the arena,
+    // both released at once, without visiting every vertex.
+    free(g->idxMap);
+    Free_Arena(g->arena);
+    Free_Arena(g->scratch);
+
+    if (g->map) munmap(g->map, g->mapLen);
+
     // Free graph itself.
     free(g);
 }
@@ -249,15 +859,13 @@ void Free_Graph(Graph *g) {
  * @param g The graph to be printed.
  */
 void Print_Graph(Graph *g) {
-    if (!g || !g->adjList || !g->idxMap) return;
+    if (!g || !g->adjList.offset || !g->idxMap) return;
 
     for (int u = 0; u < g->V; u++) {
         printf("Node [%s] : ", Get_ValNode(g, u));
 
-        GraphNode *v = g->adjList[u];
-        while (v) {
-            printf("(%s) -> ", v->name);
-            v = v->next;
+        for (int e = g->adjList.offset[u]; e < g->adjList.offset[u + 1]; e++) {
+            printf("(%s) -> ", Get_ValNode(g, g->adjList.adj[e]));
         }
 
         printf("(null)\n");
@@ -268,51 +876,41 @@ void Print_Graph(Graph *g) {
 
 /**
  * @brief Create an index map for vertex names from a buffer.
+ * The names are tokenized in place: each one is terminated by overwriting
+ * the delimiter that follows it, only a name running up to the very end
+ * of the buffer (no delimiter left to overwrite) is copied, into the arena.
  * 
  * @param V      The number of vertices.
  * @param buffer A buffer containing vertex names.
+ * @param len    The length of the buffer.
+ * @param arena  The arena holding copied names.
  * @return An array of strings representing vertex names.
  */
-char** Create_IdxMap(int V, char *buffer) {
-    char **idxMap = (char**)calloc(V, sizeof(char*));
+char** Create_IdxMap(int V, char *buffer, size_t len, Arena *arena) {
+    char **idxMap = (char**)calloc(V ? V : 1, sizeof(char*));
 
     if (!idxMap) return NULL;
 
-    int idx = 0;
+    char *pos = buffer, *end = buffer + len;
 
     for (int v = 0; v < V; v++) {
-        // Find the start of the next word
-        while (buffer[idx] && strchr(DELIM_OPER, buffer[idx])) {
-            idx++;
-        }
-        // Find the end of the current word
-        int wordStart = idx;
-        while (buffer[idx] && !strchr(DELIM_OPER, buffer[idx])) {
-            idx++;
-        }
-        if (wordStart == idx) {
-            // No more words found, so free allocated memory and return
-            for (int i = 0; i < v; i++) {
-                free(idxMap[i]);
-            }
-            free(idxMap);
-            return NULL;
+        // Find the next word and its length.
+        size_t wordLength = 0;
+        char *word = Next_Token(&pos, end, &wordLength);
+
+        if (word && pos < end) {
+            // Terminate the word in place, the delimiter is not needed anymore.
+            *pos++ = '\0';
+            idxMap[v] = word;
+        } else if (word) {
+            idxMap[v] = Strndup_Arena(arena, word, wordLength);
         }
 
-        // Calculate word length
-        int wordLength = idx - wordStart;
-        // Allocate memory for the word and copy it
-        idxMap[v] = malloc((wordLength + 1) * sizeof(char));
         if (!idxMap[v]) {
-            for (int i = 0; i <= v; i++) {
-                free(idxMap[i]);
-            }
+            // No more words found (or no memory), so free the map and return.
             free(idxMap);
             return NULL;
         }
-
-        strncpy(idxMap[v], &buffer[wordStart], wordLength);
-        idxMap[v][wordLength] = '\0';
     }
 
     return idxMap;
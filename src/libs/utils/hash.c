@@ -0,0 +1,176 @@
+#include "../include/hash.h"
+
+/**
+ * @brief Hash a string of a given length with 32-bit FNV-1a.
+ * 
+ * @param key The string to hash.
+ * @param len The number of characters to hash.
+ * @return The hash of the string.
+ */
+uint32_t Hash_Str(const char *key, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Allocate the slot arrays of a hash map.
+ * 
+ * @param map The hash map.
+ * @param cap The number of slots (power of two).
+ * @return true on success, false if the allocation failed.
+ */
+static bool Alloc_Slots(HashMap *map, int cap) {
+    map->keys = (char**)calloc(cap, sizeof(char*));
+    map->hashes = (uint32_t*)malloc(cap * sizeof(uint32_t));
+    map->vals = (int*)malloc(cap * sizeof(int));
+
+    if (!map->keys || !map->hashes || !map->vals) {
+        fprintf(stderr, "Memory HASHMAP allocation failed...");
+        free(map->keys);
+        free(map->hashes);
+        free(map->vals);
+        return false;
+    }
+
+    map->cap = cap;
+    return true;
+}
+
+/**
+ * @brief Place a key in the first free slot of its probe sequence.
+ * 
+ * @param map  The hash map.
+ * @param key  The key to place.
+ * @param hash The hash of the key.
+ * @param val  The value of the key.
+ */
+static void Place_Slot(HashMap *map, char *key, uint32_t hash, int val) {
+    uint32_t mask = (uint32_t)map->cap - 1;
+    uint32_t slot = hash & mask;
+
+    while (map->keys[slot]) {
+        slot = (slot + 1) & mask;
+    }
+
+    map->keys[slot] = key;
+    map->hashes[slot] = hash;
+    map->vals[slot] = val;
+}
+
+/**
+ * @brief Double the number of slots and reinsert every key.
+ * 
+ * @param map The hash map.
+ * @return true on success, false if the allocation failed.
+ */
+static bool Grow_HashMap(HashMap *map) {
+    HashMap old = *map;
+
+    if (!Alloc_Slots(map, 2 * old.cap)) {
+        *map = old;
+        return false;
+    }
+
+    for (int slot = 0; slot < old.cap; slot++) {
+        if (old.keys[slot]) {
+            Place_Slot(map, old.keys[slot], old.hashes[slot], old.vals[slot]);
+        }
+    }
+
+    free(old.keys);
+    free(old.hashes);
+    free(old.vals);
+    return true;
+}
+
+/**
+ * @brief Create a hash map able to hold at least cap keys without growing.
+ * 
+ * @param cap The expected number of keys.
+ * @return A pointer to the created hash map, or NULL on failure.
+ */
+HashMap* Create_HashMap(int cap) {
+    HashMap *map = (HashMap*)malloc(sizeof(HashMap));
+    if (!map) return NULL;
+
+    // Keep the load factor at most 1/2.
+    int slots = 16;
+    while (slots < 2 * cap) {
+        slots <<= 1;
+    }
+
+    map->size = 0;
+    if (!Alloc_Slots(map, slots)) {
+        free(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+/**
+ * @brief Insert a key into the hash map. The key is borrowed, not copied.
+ * 
+ * @param map The hash map.
+ * @param key The key to insert.
+ * @param val The value of the key.
+ * @return true if inserted, false if the key exists or on failure.
+ */
+bool Put_HashMap(HashMap *map, char *key, int val) {
+    if (!map || !key) return false;
+
+    size_t len = strlen(key);
+    if (Get_HashMap(map, key, len) != -1) return false;
+
+    if (2 * (map->size + 1) > map->cap && !Grow_HashMap(map))
+        return false;
+
+    Place_Slot(map, key, Hash_Str(key, len), val);
+    map->size++;
+    return true;
+}
+
+/**
+ * @brief Get the value of a key of a given length.
+ * The key does not need to be NUL-terminated.
+ * 
+ * @param map The hash map.
+ * @param key The key to look up.
+ * @param len The length of the key.
+ * @return The value of the key, or -1 if it is missing.
+ */
+int Get_HashMap(HashMap *map, const char *key, size_t len) {
+    if (!map || !key) return -1;
+
+    uint32_t hash = Hash_Str(key, len);
+    uint32_t mask = (uint32_t)map->cap - 1;
+    uint32_t slot = hash & mask;
+
+    // Probe until an empty slot, compare the cached hash before the string.
+    while (map->keys[slot]) {
+        if (map->hashes[slot] == hash
+            && !strncmp(map->keys[slot], key, len)
+            && map->keys[slot][len] == '\0')
+            return map->vals[slot];
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Free the memory occupied by the hash map (the keys are borrowed).
+ * 
+ * @param map The hash map to free.
+ */
+void Free_HashMap(HashMap *map) {
+    if (!map) return;
+    free(map->keys);
+    free(map->hashes);
+    free(map->vals);
+    free(map);
+}
@@ -0,0 +1,170 @@
+#include "../include/pool.h"
+
+// Start argument of a worker thread.
+typedef struct PoolArg {
+    Pool *pool;
+    int id;
+} PoolArg;
+
+/**
+ * @brief Claim chunks of items from the current job until none are left.
+ * 
+ * @param pool   The pool.
+ * @param worker The worker claiming the items.
+ */
+static void Drain_Pool(Pool *pool, int worker) {
+    int start;
+    while ((start = __atomic_fetch_add(&pool->next, pool->grain, __ATOMIC_RELAXED)) < pool->count) {
+        int end = start + pool->grain < pool->count ? start + pool->grain : pool->count;
+        for (int item = start; item < end; item++)
+            pool->task(pool->ctx, worker, item);
+    }
+}
+
+/**
+ * @brief Main loop of a worker thread: wait for a job, drain it, report.
+ * 
+ * @param arg The start argument (PoolArg), freed by the worker.
+ * @return NULL.
+ */
+static void* Pool_Worker(void *arg) {
+    Pool *pool = ((PoolArg*)arg)->pool;
+    int id = ((PoolArg*)arg)->id;
+    free(arg);
+
+    unsigned seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop && pool->job == seen)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+
+        Drain_Pool(pool, id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0)
+            pthread_cond_signal(&pool->idle);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/**
+ * @brief Get the number of online cores.
+ * 
+ * @return The number of cores, at least 1.
+ */
+int Cores_Pool(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+/**
+ * @brief Create a pool of workers, the calling thread being the first one.
+ * 
+ * @param size The number of workers.
+ * @return A pointer to the created pool, or NULL if allocation fails.
+ */
+Pool* Create_Pool(int size) {
+    Pool *pool = (Pool*)calloc(1, sizeof(Pool));
+
+    if (!pool) {
+        fprintf(stderr, "Memory POOL allocation failed...");
+        return NULL;
+    }
+
+    pool->size = size > 1 ? size : 1;
+    pool->threads = (pthread_t*)malloc(pool->size * sizeof(pthread_t));
+
+    if (!pool->threads) {
+        fprintf(stderr, "Memory POOL allocation failed...");
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    // Start the workers, keeping as many as could be started.
+    for (int t = 1; t < pool->size; t++) {
+        PoolArg *arg = (PoolArg*)malloc(sizeof(PoolArg));
+        if (arg) {
+            arg->pool = pool;
+            arg->id = t;
+        }
+        if (!arg || pthread_create(&pool->threads[t - 1], NULL, Pool_Worker, arg)) {
+            fprintf(stderr, "Couldn't start worker %d\n", t);
+            free(arg);
+            pool->size = t;
+            break;
+        }
+    }
+
+    return pool;
+}
+
+/**
+ * @brief Run a task on the items [0, count), the calling thread taking part,
+ * and wait until all of them are done. Without workers, or for a single
+ * item, the items simply run in order on the calling thread.
+ * 
+ * @param pool  The pool (NULL runs on the calling thread).
+ * @param count The number of items.
+ * @param task  The task to run on every item.
+ * @param ctx   The context handed to the task.
+ */
+void Run_Pool(Pool *pool, int count, PoolTask task, void *ctx) {
+    if (!pool || pool->size == 1 || count <= 1) {
+        for (int item = 0; item < count; item++)
+            task(ctx, 0, item);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->grain = count / (pool->size * POOL_GRAIN_DIV);
+    if (pool->grain < 1) pool->grain = 1;
+    pool->next = 0;
+    pool->busy = pool->size - 1;
+    pool->job++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    Drain_Pool(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0)
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Stop the workers and free the pool.
+ * 
+ * @param pool The pool to be freed.
+ */
+void Free_Pool(Pool *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int t = 1; t < pool->size; t++)
+        pthread_join(pool->threads[t - 1], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->threads);
+    free(pool);
+}
@@ -1,31 +1,64 @@
 #include "../include/queue.h"
 
 /**
- * @brief Create a new queue (wrapper over List).
+ * @brief Create a new queue, a ring buffer sized up front so that a
+ * traversal enqueuing each vertex at most once never grows it.
  * 
+ * @param cap The number of elements to hold without growing.
  * @return A pointer to the created queue.
  */
-Queue* Create_Queue(void) {
-    return Create_List();
+Queue* Create_Queue(int cap) {
+    Queue *queue = (Queue*)malloc(sizeof(Queue));
+    if (!queue) return NULL;
+
+    // Power of two slots, so positions wrap with a mask.
+    int slots = 16;
+    while (slots < cap) slots <<= 1;
+
+    queue->data = (int*)malloc(slots * sizeof(int));
+    if (!queue->data) {
+        perror("Memory QUEUE allocation failed...");
+        free(queue);
+        return NULL;
+    }
+
+    queue->cap = slots;
+    queue->head = 0;
+    queue->size = 0;
+    Add_Stats(COUNT_ALLOCS, 1);
+    return queue;
 }
 
 /**
- * @brief Check if the queue is empty (wrapper over List).
+ * @brief Check if the queue is empty.
  * 
  * @param queue The queue to check.
  * @return true if the queue is empty, false otherwise.
  */
 bool IsEmpty_Queue(Queue *queue) {
-    return IsEmpty_List(queue);
+    return !queue || !queue->size;
 }
 
 /**
- * @brief Free the memory occupied by the queue (wrapper over List).
+ * @brief Remove every element of the queue, keeping its buffer.
+ * 
+ * @param queue The queue to clear.
+ */
+void Clear_Queue(Queue *queue) {
+    if (!queue) return;
+    queue->head = 0;
+    queue->size = 0;
+}
+
+/**
+ * @brief Free the memory occupied by the queue.
  * 
  * @param queue The queue to free.
  */
 void Free_Queue(Queue *queue) {
-    Free_List(queue);
+    if (!queue) return;
+    free(queue->data);
+    free(queue);
 }
 
 /**
@@ -36,25 +69,32 @@ void Free_Queue(Queue *queue) {
  */
 int Front(Queue *queue) {
     if (IsEmpty_Queue(queue)) return -1;
-    return queue->head->prev->val;
+    return queue->data[queue->head];
 }
 
 /**
  * @brief Enqueue (add) an element to the back of the queue.
+ * A full buffer doubles, unrolling the wrapped part after the old end.
  * 
  * @param queue The queue to enqueue the element into.
  * @param val The value to enqueue.
+ * @return true on success, false if the queue could not grow.
  */
-void Enqueue(Queue *queue, int val) {
-    ListNode *node = (ListNode*)malloc(sizeof(ListNode));
-    if (!node) return;
+bool Enqueue(Queue *queue, int val) {
+    if (!queue) return false;
 
-    node->val = val;
-    node->next = queue->head->next;
-    node->prev = queue->head;
+    if (queue->size == queue->cap) {
+        int *data = (int*)realloc(queue->data, 2 * queue->cap * sizeof(int));
+        if (!data) return false;
+        // The elements before head continue after the old end.
+        memcpy(data + queue->cap, data, queue->head * sizeof(int));
+        queue->data = data;
+        queue->cap *= 2;
+    }
 
-    queue->head->next->prev = node;
-    queue->head->next = node;
+    queue->data[(queue->head + queue->size) & (queue->cap - 1)] = val;
+    queue->size++;
+    return true;
 }
 
 /**
@@ -65,9 +105,6 @@ void Enqueue(Queue *queue, int val) {
 void Dequeue(Queue *queue) {
     if (IsEmpty_Queue(queue)) return;
 
-    ListNode *temp = queue->head->prev;
-    queue->head->prev = queue->head->prev->prev;
-    queue->head->prev->next = queue->head;
-
-    free(temp);
+    queue->head = (queue->head + 1) & (queue->cap - 1);
+    queue->size--;
 }
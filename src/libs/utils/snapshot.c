@@ -0,0 +1,322 @@
+#include "../include/snapshot.h"
+
+#define SNAP_SEED 0x243F6A8885A308D3ull
+#define SNAP_MULT 0x9E3779B97F4A7C15ull
+
+// Start of every section of a snapshot, from its header counts.
+typedef struct SnapLayout {
+    size_t pool;            // String pool.
+    size_t names;           // Offset of every name in the pool (uint64_t).
+    size_t offset;          // Forward CSR offsets (V + 1 ints).
+    size_t adj;             // Forward CSR neighbors (E ints).
+    size_t offsetT;         // Transposed CSR offsets (V + 1 ints).
+    size_t adjT;            // Transposed CSR neighbors (E ints).
+    size_t size;            // Total size of the snapshot.
+} SnapLayout;
+
+/* ----------------------------------------------------------------------------------- */
+
+/**
+ * @brief Round a size up to a multiple of 8 bytes.
+ *
+ * @param n The size.
+ * @return The padded size.
+ */
+static inline size_t Pad8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+/**
+ * @brief Compute where every section of a snapshot starts.
+ *
+ * @param V       The number of vertices.
+ * @param E       The number of edges.
+ * @param poolLen The length of the string pool.
+ * @param l       The layout to fill.
+ */
+static void Snap_Layout(size_t V, size_t E, size_t poolLen, SnapLayout *l) {
+    l->pool = sizeof(SnapHeader);
+    l->names = l->pool + Pad8(poolLen);
+    l->offset = l->names + Pad8(V * sizeof(uint64_t));
+    l->adj = l->offset + Pad8((V + 1) * sizeof(int));
+    l->offsetT = l->adj + Pad8(E * sizeof(int));
+    l->adjT = l->offsetT + Pad8((V + 1) * sizeof(int));
+    l->size = l->adjT + Pad8(E * sizeof(int));
+}
+
+/**
+ * @brief Fold a buffer into a running checksum, one 64-bit word at a time.
+ * A trailing partial word is zero padded, like the sections on disk.
+ *
+ * @param h    The running checksum.
+ * @param data The buffer.
+ * @param len  The length of the buffer.
+ * @return The updated checksum.
+ */
+static uint64_t Mix_Words(uint64_t h, const char *data, size_t len) {
+    for (size_t i = 0; i < len; i += 8) {
+        uint64_t w = 0;
+        memcpy(&w, data + i, len - i < 8 ? len - i : 8);
+        h = (h ^ w) * SNAP_MULT;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+/**
+ * @brief Write a section, zero padded to 8 bytes, and fold it into the checksum.
+ *
+ * @param fout The snapshot file.
+ * @param data The section.
+ * @param len  The length of the section.
+ * @param h    The running checksum.
+ * @return true on success, false if the write failed.
+ */
+static bool Write_Section(FILE *fout, const void *data, size_t len, uint64_t *h) {
+    static const char zeros[8] = { 0 };
+    size_t pad = Pad8(len) - len;
+
+    if (len && fwrite(data, 1, len, fout) != len) return false;
+    if (pad && fwrite(zeros, 1, pad, fout) != pad) return false;
+
+    *h = Mix_Words(*h, (const char*)data, len);
+    return true;
+}
+
+/* ----------------------------------------------------------------------------------- */
+
+/**
+ * @brief Check if a buffer starts with the snapshot magic.
+ *
+ * @param buffer The buffer.
+ * @param len    The length of the buffer.
+ * @return true if the buffer holds a snapshot.
+ */
+bool Is_Snapshot(const char *buffer, size_t len) {
+    return buffer && len >= sizeof(SnapHeader) && !memcmp(buffer, SNAP_MAGIC, 8);
+}
+
+/**
+ * @brief Check that a CSR adjacency read from a snapshot is well formed:
+ * the offsets start at 0, never decrease and end at E, and every neighbor
+ * is a vertex. O(V + E).
+ *
+ * @param offset The offsets (V + 1 ints).
+ * @param adj    The neighbors (E ints).
+ * @param V      The number of vertices.
+ * @param E      The number of edges.
+ * @return true if the adjacency is valid.
+ */
+static bool Check_CSR(const int *offset, const int *adj, int V, int E) {
+    if (offset[0] != 0 || offset[V] != E) return false;
+
+    for (int u = 0; u < V; u++) {
+        if (offset[u] > offset[u + 1]) return false;
+    }
+
+    for (int i = 0; i < E; i++) {
+        if (adj[i] < 0 || adj[i] >= V) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Free what Load_Snapshot allocated, leaving the mapping alone.
+ *
+ * @param g The partially loaded graph.
+ */
+static void Drop_Graph(Graph *g) {
+    Free_Arena(g->arena);
+    Free_Arena(g->scratch);
+    Free_HashMap(g->idxHash);
+    Free_BitSet(g->tips);
+    free(g->idxMap);
+    free(g->rank);
+    free(g->byRank);
+    free(g->nameLen);
+    free(g->prunedPast);
+    free(g);
+}
+
+/**
+ * @brief Load a graph from a mapped snapshot.
+ * The names and both CSR adjacencies stay in the mapping, only the index
+ * map, the symbol table and the tips are built (O(V)). The graph owns the
+ * mapping on success: Free_Graph unmaps it, and the borrowed arrays are
+ * copied out the first time a block is appended.
+ *
+ * @param map The mapping of the snapshot file.
+ * @param len The length of the mapping.
+ * @return A pointer to the loaded graph, or NULL if the snapshot is invalid.
+ */
+Graph* Load_Snapshot(char *map, size_t len) {
+    if (!Is_Snapshot(map, len)) {
+        fprintf(stderr, "Invalid snapshot header");
+        return NULL;
+    }
+
+    SnapHeader hdr;
+    memcpy(&hdr, map, sizeof(SnapHeader));
+
+    if (hdr.version != SNAP_VERSION || hdr.V > INT32_MAX || hdr.E > INT32_MAX) {
+        fprintf(stderr, "Unsupported snapshot version");
+        return NULL;
+    }
+
+    // A pool longer than the file would wrap the layout below.
+    if (hdr.poolLen > len) {
+        fprintf(stderr, "Truncated snapshot");
+        return NULL;
+    }
+
+    SnapLayout l;
+    Snap_Layout(hdr.V, hdr.E, hdr.poolLen, &l);
+
+    if (l.size != len) {
+        fprintf(stderr, "Truncated snapshot");
+        return NULL;
+    }
+
+    if (Mix_Words(SNAP_SEED, map + l.pool, len - l.pool) != hdr.checksum) {
+        fprintf(stderr, "Snapshot checksum mismatch");
+        return NULL;
+    }
+
+    int V = (int)hdr.V, E = (int)hdr.E;
+    const uint64_t *names = (const uint64_t*)(map + l.names);
+    int *offset = (int*)(map + l.offset);
+    int *offsetT = (int*)(map + l.offsetT);
+
+    // The checksum has no key, so it only guards against corruption:
+    // every section is checked as if the file were hostile.
+    if (!Check_CSR(offset, (const int*)(map + l.adj), V, E) ||
+        !Check_CSR(offsetT, (const int*)(map + l.adjT), V, E) ||
+        (hdr.poolLen && map[l.pool + hdr.poolLen - 1] != '\0')) {
+        fprintf(stderr, "Invalid snapshot sections");
+        return NULL;
+    }
+
+    Graph *g = (Graph*)calloc(1, sizeof(Graph));
+
+    if (!g) {
+        fprintf(stderr, "Memory GRAPH allocation failed...");
+        return NULL;
+    }
+
+    g->V = V;
+    g->E = E;
+    g->idxMap = (char**)malloc((V ? V : 1) * sizeof(char*));
+    g->idxHash = Create_HashMap(V);
+    g->arena = Create_Arena(0);
+    g->scratch = Create_Arena(0);
+
+    if (!g->idxMap || !g->idxHash || !g->arena || !g->scratch) {
+        fprintf(stderr, "Memory ADJLIST allocation failed...");
+        Drop_Graph(g);
+        return NULL;
+    }
+
+    // The names are views into the string pool.
+    for (int u = 0; u < V; u++) {
+        if (names[u] >= hdr.poolLen) {
+            fprintf(stderr, "Invalid snapshot sections");
+            Drop_Graph(g);
+            return NULL;
+        }
+        g->idxMap[u] = map + l.pool + names[u];
+
+        // Fails on a duplicate name as well as on a failed allocation.
+        if (!Put_HashMap(g->idxHash, g->idxMap[u], u)) {
+            fprintf(stderr, "Invalid snapshot sections");
+            Drop_Graph(g);
+            return NULL;
+        }
+    }
+
+    // Both adjacencies are borrowed from the mapping, full to capacity.
+    g->adjList.offset = offset;
+    g->adjList.adj = E ? (int*)(map + l.adj) : NULL;
+    g->adjListT.offset = offsetT;
+    g->adjListT.adj = E ? (int*)(map + l.adjT) : NULL;
+    g->capV = V;
+    g->capE = E;
+    g->staleT = false;
+
+    if (!Create_Tips(g)) {
+        Drop_Graph(g);
+        return NULL;
+    }
+
+    g->map = map;
+    g->mapLen = len;
+    return g;
+}
+
+/**
+ * @brief Write a graph to a snapshot file.
+ * The header is written last, once the checksum of the sections is known.
+ *
+ * @param g    The graph.
+ * @param path The path of the snapshot file.
+ * @return true on success, false on failure.
+ */
+bool Save_Snapshot(Graph *g, const char *path) {
+    if (!g || !path || !Refresh_TCSR(g)) return false;
+
+    // Lay the names out back to back, each one NUL terminated.
+    uint64_t *names = (uint64_t*)malloc((g->V ? g->V : 1) * sizeof(uint64_t));
+    if (!names) return false;
+
+    size_t poolLen = 0;
+    for (int u = 0; u < g->V; u++) {
+        names[u] = poolLen;
+        poolLen += strlen(g->idxMap[u]) + 1;
+    }
+
+    char *pool = (char*)malloc(poolLen ? poolLen : 1);
+    if (!pool) {
+        free(names);
+        return false;
+    }
+    for (int u = 0; u < g->V; u++) {
+        memcpy(pool + names[u], g->idxMap[u], strlen(g->idxMap[u]) + 1);
+    }
+
+    FILE *fout = fopen(path, "wb");
+
+    if (!fout) {
+        free(names);
+        free(pool);
+        return false;
+    }
+
+    SnapHeader hdr;
+    memset(&hdr, 0, sizeof(SnapHeader));
+    memcpy(hdr.magic, SNAP_MAGIC, 8);
+    hdr.version = SNAP_VERSION;
+    hdr.V = (uint32_t)g->V;
+    hdr.E = (uint32_t)g->E;
+    hdr.poolLen = poolLen;
+
+    uint64_t h = SNAP_SEED;
+    bool written = fwrite(&hdr, sizeof(SnapHeader), 1, fout) == 1 &&
+        Write_Section(fout, pool, poolLen, &h) &&
+        Write_Section(fout, names, g->V * sizeof(uint64_t), &h) &&
+        Write_Section(fout, g->adjList.offset, (g->V + 1) * sizeof(int), &h) &&
+        Write_Section(fout, g->adjList.adj, g->E * sizeof(int), &h) &&
+        Write_Section(fout, g->adjListT.offset, (g->V + 1) * sizeof(int), &h) &&
+        Write_Section(fout, g->adjListT.adj, g->E * sizeof(int), &h);
+
+    long size = ftell(fout);
+    if (written && size > 0) Add_Stats(COUNT_WRITTEN, (uint64_t)size);
+
+    // Seal the snapshot with the checksum of its sections.
+    hdr.checksum = h;
+    written = written && !fseek(fout, 0, SEEK_SET) &&
+              fwrite(&hdr, sizeof(SnapHeader), 1, fout) == 1;
+
+    free(names);
+    free(pool);
+    return !fclose(fout) && written;
+}
@@ -1,31 +1,55 @@
 #include "../include/stack.h"
 
 /**
- * @brief Create a new stack (wrapper over List).
+ * @brief Create a new stack, a contiguous array grown geometrically.
  * 
+ * @param cap The number of elements to hold without growing.
  * @return A pointer to the created stack.
  */
-Stack* Create_Stack(void) {
-    return Create_List();
+Stack* Create_Stack(int cap) {
+    Stack *stack = (Stack*)malloc(sizeof(Stack));
+    if (!stack) return NULL;
+
+    stack->cap = cap > 16 ? cap : 16;
+    stack->data = (int*)malloc(stack->cap * sizeof(int));
+    if (!stack->data) {
+        perror("Memory STACK allocation failed...");
+        free(stack);
+        return NULL;
+    }
+
+    stack->size = 0;
+    return stack;
 }
 
 /**
- * @brief Check if the stack is empty (wrapper over List).
+ * @brief Check if the stack is empty.
  * 
  * @param stack The stack to check.
  * @return true if the stack is empty, false otherwise.
  */
 bool IsEmpty_Stack(Stack *stack) {
-    return IsEmpty_List(stack);
+    return !stack || !stack->size;
 }
 
 /**
- * @brief Free the memory occupied by the stack (wrapper over List).
+ * @brief Remove every element of the stack, keeping its array.
+ * 
+ * @param stack The stack to clear.
+ */
+void Clear_Stack(Stack *stack) {
+    if (stack) stack->size = 0;
+}
+
+/**
+ * @brief Free the memory occupied by the stack.
  * 
  * @param stack The stack to free.
  */
 void Free_Stack(Stack *stack) {
-    Free_List(stack);
+    if (!stack) return;
+    free(stack->data);
+    free(stack);
 }
 
 /**
@@ -36,38 +60,35 @@ void Free_Stack(Stack *stack) {
  */
 int Top(Stack *stack) {
     if (IsEmpty_Stack(stack)) return -1;
-    return stack->head->next->val;
+    return stack->data[stack->size - 1];
 }
 
 /**
- * @brief Push (add) an element onto the stack.
+ * @brief Push an element onto the top of the stack.
  * 
  * @param stack The stack to push the element onto.
- * @param val The value to push onto the stack.
+ * @param val The value to push.
+ * @return true on success, false if the stack could not grow.
  */
-void Push(Stack *stack, int val) {
-    ListNode *node = (ListNode*)malloc(sizeof(ListNode));
-    if (!node) return;
+bool Push(Stack *stack, int val) {
+    if (!stack) return false;
 
-    node->val = val;
-    node->next = stack->head->next;
-    node->prev = stack->head;
+    if (stack->size == stack->cap) {
+        int *data = (int*)realloc(stack->data, 2 * stack->cap * sizeof(int));
+        if (!data) return false;
+        stack->data = data;
+        stack->cap *= 2;
+    }
 
-    stack->head->next->prev = node;
-    stack->head->next = node;
+    stack->data[stack->size++] = val;
+    return true;
 }
 
 /**
- * @brief Pop (remove) the top element from the stack.
+ * @brief Pop the top element from the stack.
  * 
  * @param stack The stack to pop from.
  */
 void Pop(Stack *stack) {
-    if (IsEmpty_Stack(stack)) return;
-
-    ListNode *temp = stack->head->next;
-    stack->head->next = stack->head->next->next;
-    stack->head->next->prev = stack->head;
-
-    free(temp);
+    if (!IsEmpty_Stack(stack)) stack->size--;
 }
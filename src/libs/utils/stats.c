@@ -0,0 +1,61 @@
+#include "../include/stats.h"
+
+Stats Global_Stats = { 0 };
+
+// JSON names of the phases and counters, in enum order.
+static const char *Phase_Names[PHASE_COUNT] = {
+    "load", "idxmap", "edges", "csr", "tcsr", "topo", "search", "sets", "cones", "output"
+};
+static const char *Count_Names[COUNT_COUNT] = {
+    "edges_visited", "nodes_visited", "lookups", "allocs", "bytes_read", "bytes_written", "queries"
+};
+
+/**
+ * @brief Read the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+uint64_t Clock_Stats(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Start collecting statistics, from zero.
+ */
+void Enable_Stats(void) {
+    memset(&Global_Stats, 0, sizeof(Stats));
+    Global_Stats.start = Clock_Stats();
+    Global_Stats.on = true;
+}
+
+/**
+ * @brief Write the statistics as a single line JSON object: the wall time
+ * and peak resident memory of the run, every phase (milliseconds, calls)
+ * and every counter.
+ *
+ * @param fout    The file to write to.
+ * @param command The command of the run.
+ */
+void Report_Stats(FILE *fout, const char *command) {
+    if (!Global_Stats.on || !fout) return;
+
+    struct rusage usage;
+    long peak = getrusage(RUSAGE_SELF, &usage) ? 0 : usage.ru_maxrss;
+
+    fprintf(fout, "{\"command\":\"%s\",\"wall_ms\":%.3f,\"peak_rss_kb\":%ld,\"phases\":{",
+            command ? command : "", (Clock_Stats() - Global_Stats.start) / 1e6, peak);
+
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        fprintf(fout, "%s\"%s\":{\"ms\":%.3f,\"calls\":%llu}", p ? "," : "", Phase_Names[p],
+                Global_Stats.time[p] / 1e6, (unsigned long long)Global_Stats.calls[p]);
+    }
+
+    fprintf(fout, "},\"counters\":{");
+    for (int c = 0; c < COUNT_COUNT; c++) {
+        fprintf(fout, "%s\"%s\":%llu", c ? "," : "", Count_Names[c],
+                (unsigned long long)Global_Stats.count[c]);
+    }
+    fprintf(fout, "}}\n");
+}
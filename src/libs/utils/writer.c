@@ -0,0 +1,257 @@
+#include "../include/writer.h"
+
+/**
+ * @brief Allocate a writer on a descriptor.
+ *
+ * @param fd    The descriptor, -1 for memory.
+ * @param owned The descriptor is closed with the writer.
+ * @return A pointer to the writer, or NULL if allocation fails.
+ */
+static Writer* New_Writer(int fd, bool owned) {
+    Writer *w = (Writer*)malloc(sizeof(Writer));
+    char *buf = (char*)malloc(WRITER_BUFFER);
+
+    if (!w || !buf) {
+        fprintf(stderr, "Memory WRITER allocation failed...");
+        free(w);
+        free(buf);
+        return NULL;
+    }
+
+    w->fd = fd;
+    w->owned = owned;
+    w->failed = false;
+    w->buf = buf;
+    w->len = 0;
+    w->cap = WRITER_BUFFER;
+    w->written = 0;
+    Add_Stats(COUNT_ALLOCS, 1);
+    return w;
+}
+
+/**
+ * @brief Open a writer on a file, created or truncated, or on stdout.
+ *
+ * @param path The path of the file, NULL or "-" for stdout.
+ * @return A pointer to the writer, or NULL on failure.
+ */
+Writer* Open_Writer(const char *path) {
+    if (!path || !strcmp(path, "-")) return Attach_Writer(STDOUT_FILENO);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return NULL;
+
+    Writer *w = New_Writer(fd, true);
+    if (!w) close(fd);
+    return w;
+}
+
+/**
+ * @brief Open a writer on a descriptor, which stays open once the writer is
+ * closed (stdout, a connection closed by its owner).
+ *
+ * @param fd The descriptor.
+ * @return A pointer to the writer, or NULL if allocation fails.
+ */
+Writer* Attach_Writer(int fd) {
+    return New_Writer(fd, false);
+}
+
+/**
+ * @brief Create a writer keeping its output in memory: the buffer grows
+ * instead of being flushed, buf[0 .. len) holds everything written.
+ *
+ * @return A pointer to the writer, or NULL if allocation fails.
+ */
+Writer* Create_Writer(void) {
+    return New_Writer(-1, false);
+}
+
+/**
+ * @brief Hand the pending bytes to the file, retrying partial writes.
+ * A memory writer keeps them.
+ *
+ * @param w The writer.
+ * @return true on success, false if a write failed.
+ */
+bool Flush_Writer(Writer *w) {
+    if (!w) return false;
+    if (w->fd == -1) return !w->failed;
+
+    size_t done = 0;
+    while (done < w->len) {
+        ssize_t n = write(w->fd, w->buf + done, w->len - done);
+        if (n <= 0) {
+            w->failed = true;
+            break;
+        }
+        done += (size_t)n;
+    }
+
+    w->written += done;
+    w->len = 0;
+    return !w->failed;
+}
+
+/**
+ * @brief Make room for more bytes: flush a file writer, grow a memory one.
+ *
+ * @param w    The writer.
+ * @param need The bytes to be appended.
+ * @return true if the buffer has room for them.
+ */
+static bool Room_Writer(Writer *w, size_t need) {
+    if (w->len + need <= w->cap) return true;
+
+    if (w->fd != -1) {
+        Flush_Writer(w);
+        // Larger than the whole buffer: written straight through by the caller.
+        return need <= w->cap;
+    }
+
+    size_t cap = w->cap;
+    while (cap < w->len + need) cap *= 2;
+
+    char *buf = (char*)realloc(w->buf, cap);
+    if (!buf) {
+        w->failed = true;
+        return false;
+    }
+
+    w->buf = buf;
+    w->cap = cap;
+    return true;
+}
+
+/**
+ * @brief Append bytes to the writer.
+ *
+ * @param w    The writer.
+ * @param data The bytes.
+ * @param len  The number of bytes.
+ */
+void Put_Bytes(Writer *w, const char *data, size_t len) {
+    if (!w || !len) return;
+
+    if (Room_Writer(w, len)) {
+        memcpy(w->buf + w->len, data, len);
+        w->len += len;
+        return;
+    }
+
+    // A block larger than the buffer of a file writer skips the copy.
+    if (w->fd != -1 && !w->failed) {
+        size_t done = 0;
+        while (done < len) {
+            ssize_t n = write(w->fd, data + done, len - done);
+            if (n <= 0) {
+                w->failed = true;
+                break;
+            }
+            done += (size_t)n;
+        }
+        w->written += done;
+    }
+}
+
+/**
+ * @brief Append a NUL terminated string to the writer.
+ *
+ * @param w   The writer.
+ * @param str The string.
+ */
+void Put_Str(Writer *w, const char *str) {
+    Put_Bytes(w, str, strlen(str));
+}
+
+/**
+ * @brief Append a single character to the writer.
+ *
+ * @param w The writer.
+ * @param c The character.
+ */
+void Put_Char(Writer *w, char c) {
+    if (w && (w->len < w->cap || Room_Writer(w, 1)))
+        w->buf[w->len++] = c;
+}
+
+/**
+ * @brief Append a decimal integer to the writer.
+ *
+ * @param w     The writer.
+ * @param value The integer.
+ */
+void Put_Int(Writer *w, long value) {
+    char digits[24];
+    int len = sizeof(digits);
+    unsigned long u = value < 0 ? -(unsigned long)value : (unsigned long)value;
+
+    // Digits backwards from the end of the scratch.
+    do {
+        digits[--len] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (value < 0) digits[--len] = '-';
+
+    Put_Bytes(w, digits + len, sizeof(digits) - len);
+}
+
+/**
+ * @brief Append printf formatted text to the writer, formatted in place.
+ *
+ * @param w   The writer.
+ * @param fmt The format.
+ */
+void Put_Format(Writer *w, const char *fmt, ...) {
+    if (!w || !Room_Writer(w, WRITER_LINE)) return;
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->buf + w->len, w->cap - w->len, fmt, args);
+    va_end(args);
+
+    if (n < 0) {
+        w->failed = true;
+        return;
+    }
+
+    // Longer than the room left: make room for it and format again.
+    if ((size_t)n >= w->cap - w->len) {
+        if (!Room_Writer(w, (size_t)n + 1)) {
+            w->failed = true;
+            return;
+        }
+        va_start(args, fmt);
+        vsnprintf(w->buf + w->len, w->cap - w->len, fmt, args);
+        va_end(args);
+    }
+
+    w->len += (size_t)n;
+}
+
+/**
+ * @brief Empty the buffer of the writer, dropping the pending bytes.
+ *
+ * @param w The writer.
+ */
+void Reset_Writer(Writer *w) {
+    if (w) w->len = 0;
+}
+
+/**
+ * @brief Flush, close and free a writer.
+ *
+ * @param w The writer.
+ * @return true if every byte was written, false otherwise.
+ */
+bool Close_Writer(Writer *w) {
+    if (!w) return false;
+
+    bool ok = Flush_Writer(w);
+    if (w->fd != -1) Add_Stats(COUNT_WRITTEN, w->written);
+    if (w->owned && close(w->fd)) ok = false;
+
+    free(w->buf);
+    free(w);
+    return ok;
+}